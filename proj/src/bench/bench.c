@@ -0,0 +1,66 @@
+/**
+ * @file bench.c
+ * @brief Benchmark selection and timing helpers
+ */
+
+#include "bench.h"
+#include "../device/timer.h"
+#include <sys/time.h>
+
+/**
+ * @brief Gets the current time
+ *
+ * On MINIX gettimeofday() only advances once per clock tick, too coarse to time
+ * a frame, so the time stamp counter is used when its frequency is known.
+ *
+ * @return The current time in microseconds
+ */
+
+uint64_t bench_now_us() {
+  uint64_t us;
+  if (timer_read_tsc_us(&us) == 0)
+    return us;
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (uint64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+#ifndef LCOM_HOST
+/**
+ * @brief Gets the number of heap allocations so far
+ *
+ * Only the host build counts them (see host/host_alloc.c).
+ *
+ * @param allocs Receives the calls to malloc(), calloc() and realloc()
+ * @param frees Receives the calls to free()
+ * @return 1, the counts are not available
+ */
+
+int bench_alloc_counts(unsigned long *allocs, unsigned long *frees) {
+  return 1;
+}
+#endif
+
+/**
+ * @brief Runs the benchmark named by the first argument
+ *
+ * @param argc The number of arguments
+ * @param argv The arguments, argv[0] being the benchmark name
+ * @return 0 on success, non-zero otherwise
+ */
+
+int run_benchmark(int argc, char *argv[]) {
+  if (strcmp(argv[0], "assets") == 0)
+    return bench_assets(argc, argv);
+  if (strcmp(argv[0], "blit") == 0)
+    return bench_blit(argc, argv);
+  if (strcmp(argv[0], "frames") == 0)
+    return bench_frames(argc, argv);
+  if (strcmp(argv[0], "kernels") == 0)
+    return bench_kernels(argc, argv);
+  if (strcmp(argv[0], "vram") == 0)
+    return bench_vram(argc, argv);
+
+  printf("unknown benchmark \"%s\", available: assets, blit, frames, kernels, vram\n", argv[0]);
+  return 1;
+}
@@ -0,0 +1,49 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <lcom/lcf.h>
+#include <stdint.h>
+
+/** @defgroup bench Benchmarks
+ * @{
+ *
+ * Benchmarks run instead of the game when proj is started with arguments,
+ * e.g. "lcom_run proj assets".
+ */
+
+/** Runs the benchmark named by argv[0]
+ */
+int run_benchmark(int argc, char *argv[]);
+
+/** Current time in microseconds
+ */
+uint64_t bench_now_us();
+
+/** Gets the number of heap allocations and frees so far, returns 0 if the
+ *  platform counts them
+ */
+int bench_alloc_counts(unsigned long *allocs, unsigned long *frees);
+
+/** Compares loading every asset from its XPM with loading its baked pixmap
+ */
+int bench_assets(int argc, char *argv[]);
+
+/** Compares drawing sprites pixel by pixel with drawing their opaque spans
+ */
+int bench_blit(int argc, char *argv[]);
+
+/** Times game frames with many enemies, step by step
+ */
+int bench_frames(int argc, char *argv[]);
+
+/** Compares the portable and SIMD row kernels at sprite and screen sizes
+ */
+int bench_kernels(int argc, char *argv[]);
+
+/** Compares composing frames in VRAM with composing them in system memory and uploading them
+ */
+int bench_vram(int argc, char *argv[]);
+
+/** @} end of bench */
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * @file bench_assets.c
+ * @brief Startup benchmark: XPM parsing versus baked pixmaps
+ */
+
+#include "bench.h"
+#include "../view/game_view.h"
+#include "../menu/menu.h"
+
+/** @brief An asset and the loading state that decodes it */
+typedef struct {
+  const char *state;
+  AssetId asset;
+} BenchAsset;
+
+/** @brief Every asset decoded on the way to the main menu and into a game */
+static const BenchAsset assets[] = {
+  {"INITIAL", ASSET_MENU_FONT_SELECTED},
+  {"INITIAL", ASSET_MENU_FONT_UNSELECTED},
+  {"INITIAL", ASSET_MENU_NUMBERS},
+  {"INITIAL", ASSET_TITLE_FONT},
+  {"INITIAL", ASSET_GAME_LETTERS},
+  {"INITIAL", ASSET_GAME_NUMBERS},
+  {"INITIAL", ASSET_TANK1},
+  {"INITIAL", ASSET_TANK2},
+  {"INITIAL", ASSET_TANK3},
+  {"INITIAL", ASSET_TANK4},
+  {"INITIAL", ASSET_TANK5},
+  {"INITIAL", ASSET_TANK6},
+  {"INITIAL", ASSET_TANK7},
+  {"INITIAL", ASSET_TANK8},
+  {"INITIAL", ASSET_TANK9},
+  {"INITIAL", ASSET_TANK10},
+  {"INITIAL", ASSET_TANK11},
+  {"INITIAL", ASSET_TANK12},
+  {"INITIAL", ASSET_CROSSHAIR},
+  {"INITIAL", ASSET_CURSOR},
+  {"INITIAL", ASSET_VIRUS40},
+  {"INITIAL", ASSET_VIRUS50_1},
+  {"INITIAL", ASSET_VIRUS50_2},
+  {"INITIAL", ASSET_VIRUS50_3},
+  {"INITIAL", ASSET_VIRUS50_4},
+  {"INITIAL", ASSET_VIRUS50_5},
+  {"INITIAL", ASSET_EXPLOSION1},
+  {"INITIAL", ASSET_EXPLOSION2},
+  {"INITIAL", ASSET_EXPLOSION3},
+  {"INITIAL", ASSET_EXPLOSION4},
+  {"INITIAL", ASSET_EXPLOSION5},
+  {"INITIAL", ASSET_EXPLOSION6},
+  {"INITIAL", ASSET_EXPLOSION7},
+  {"INITIAL", ASSET_EXPLOSION8},
+  {"INITIAL", ASSET_EXPLOSION9},
+  {"INITIAL", ASSET_EXPLOSION10},
+  {"INITIAL", ASSET_EXPLOSION11},
+  {"INITIAL", ASSET_EXPLOSION12},
+  {"INITIAL", ASSET_EXPLOSION13},
+  {"INITIAL", ASSET_EXPLOSION14},
+  {"INITIAL", ASSET_EXPLOSION15},
+  {"INITIAL", ASSET_EXPLOSION16},
+  {"INITIAL", ASSET_EXPLOSION17},
+  {"INITIAL", ASSET_EXPLOSION18},
+  {"INITIAL", ASSET_EXPLOSION19},
+  {"INITIAL", ASSET_EXPLOSION20},
+  {"INITIAL", ASSET_INITIAL_MENU},
+  {"LOADING_MAIN_MENU", ASSET_MAIN_MENU},
+  {"LOADING_HELP", ASSET_HELP_MENU},
+  {"LOADING_HIGHSCORES", ASSET_HIGHSCORES_MENU},
+  {"LOADING_PAUSE", ASSET_PAUSE_MENU},
+  {"GAME_END", ASSET_GAME_OVER_MENU},
+  {"LOADING_GAME", ASSET_ARENA3},
+  {"LOADING_GAME", ASSET_ARENA4},
+  {"LOADING_GAME", ASSET_ARENA5},
+  {"LOADING_GAME", ASSET_ARENA2},
+};
+
+#define NUM_BENCH_ASSETS (sizeof(assets) / sizeof(assets[0]))
+
+/**
+ * @brief Times the two ways of loading every asset
+ *
+ * Each asset is decoded with xpm_load() and read from its baked blob. Both
+ * results are compared byte by byte, so the benchmark also checks that the
+ * build step produced the same pixels LCF would. Timings are summed per
+ * loading state, so the cost of e.g. LOADING_MAIN_MENU can be read directly.
+ *
+ * @param argc The number of arguments
+ * @param argv The arguments, an optional argv[1] sets the number of rounds
+ * @return 0 if every baked pixmap matched its XPM, 1 otherwise
+ */
+
+int bench_assets(int argc, char *argv[]) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 1;
+  if (rounds < 1)
+    rounds = 1;
+  uint64_t xpm_total = 0, baked_total = 0;
+  uint64_t state_xpm = 0, state_baked = 0;
+  int mismatches = 0;
+
+  printf("%-20s %-22s %12s %12s\n", "state", "asset", "xpm (us)", "baked (us)");
+  for (unsigned i = 0; i < NUM_BENCH_ASSETS; i++) {
+    const BenchAsset *asset = &assets[i];
+    xpm_image_t xpm_img, baked_img;
+    uint8_t *xpm_map = NULL, *baked_map = NULL;
+    uint64_t xpm_time = 0, baked_time = 0;
+
+    for (int r = 0; r < rounds; r++) {
+      free(xpm_map);
+      free(baked_map);
+      uint64_t start = bench_now_us();
+      xpm_map = xpm_load(asset_xpm(asset->asset), XPM_8_8_8, &xpm_img);
+      uint64_t middle = bench_now_us();
+      baked_map = load_baked_pixmap(asset_name(asset->asset), &baked_img, NULL);
+      uint64_t end = bench_now_us();
+      xpm_time += middle - start;
+      baked_time += end - middle;
+    }
+    xpm_time /= rounds;
+    baked_time /= rounds;
+
+    if (baked_map == NULL)
+      printf("%-20s %-22s %12llu %12s\n", asset->state, asset_name(asset->asset), (unsigned long long) xpm_time, "not baked");
+    else {
+      if (xpm_map == NULL || xpm_img.width != baked_img.width || xpm_img.height != baked_img.height ||
+          memcmp(xpm_map, baked_map, baked_img.size) != 0) {
+        printf("%s: baked pixmap differs from its XPM\n", asset_name(asset->asset));
+        mismatches++;
+      }
+      printf("%-20s %-22s %12llu %12llu\n", asset->state, asset_name(asset->asset), (unsigned long long) xpm_time, (unsigned long long) baked_time);
+    }
+    free(xpm_map);
+    free(baked_map);
+
+    state_xpm += xpm_time;
+    state_baked += baked_time;
+    if (i + 1 == NUM_BENCH_ASSETS || strcmp(assets[i + 1].state, asset->state) != 0) {
+      printf("%-20s %-22s %12llu %12llu\n\n", asset->state, "total", (unsigned long long) state_xpm, (unsigned long long) state_baked);
+      xpm_total += state_xpm;
+      baked_total += state_baked;
+      state_xpm = state_baked = 0;
+    }
+  }
+  printf("%-43s %12llu %12llu\n", "all assets", (unsigned long long) xpm_total, (unsigned long long) baked_total);
+
+  return mismatches != 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file bench_blit.c
+ * @brief Drawing benchmark: per-pixel transparency test versus opaque spans
+ */
+
+#include "bench.h"
+#include "../view/game_view.h"
+#include "../menu/menu.h"
+
+/** @brief An area of an asset drawn by the game, e.g. a sprite or one glyph */
+typedef struct {
+  const char *label;
+  AssetId asset;
+  uint16_t x, width;  ///< columns of the area, width 0 meaning the whole pixmap
+} BlitAsset;
+
+/** @brief Sprites, animation frames and glyphs drawn every frame */
+static const BlitAsset assets[] = {
+  {"cursor", ASSET_CURSOR, 0, 0},
+  {"crosshair", ASSET_CROSSHAIR, 0, 0},
+  {"tank", ASSET_TANK1, 0, 0},
+  {"virus1", ASSET_VIRUS40, 0, 0},
+  {"virus2 frame", ASSET_VIRUS50_1, 0, 0},
+  {"explosion frame", ASSET_EXPLOSION10, 0, 0},
+  {"game glyph 'S'", ASSET_GAME_LETTERS, ('S' - 'A') * (GAME_FONT_WIDTH + GAME_FONT_OFFSET), GAME_FONT_WIDTH},
+  {"title glyph 'B'", ASSET_TITLE_FONT, ('B' - 'A') * (TITLE_FONT_WIDTH + TITLE_FONT_OFFSET), TITLE_FONT_WIDTH},
+  {"menu background", ASSET_MAIN_MENU, 0, 0},
+};
+
+#define NUM_BLIT_ASSETS (sizeof(assets) / sizeof(assets[0]))
+
+/**
+ * @brief The drawing loop replaced by the spans, kept as the reference
+ *
+ * Every pixel is rebuilt from its 3 bytes, compared with the transparency
+ * colour and written on its own, as draw_sprite() and draw_character() did.
+ * Pixels off the buffer are skipped one by one.
+ */
+
+static void draw_pixels(const uint8_t *map, uint16_t pitch, uint16_t area_x, uint16_t width, uint16_t height,
+                        char *buffer, unsigned h_res, unsigned v_res, int x, int y) {
+  uint32_t color;
+  uint32_t desl;
+  int color_index;
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      desl = (i * pitch + area_x + j) * 3;
+      color = map[desl] | (map[desl + 1] << 8) | (map[desl + 2] << 16);
+      if (x + j < 0 || x + j >= (int) h_res || y + i < 0 || y + i >= (int) v_res)
+        continue;
+      if (color != xpm_transparency_color(XPM_8_8_8)) {
+        color_index = (h_res * (y + i) + (x + j)) * VG_PIXEL_BYTES;
+        vg_pack_pixel(buffer + color_index, color);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Measures how many pixels per second each way of drawing reaches
+ *
+ * Both ways draw into their own screen sized buffer in system memory, so the
+ * benchmark does not need a video mode. Each way then draws the asset across
+ * two corners of the screen, and the buffers are compared to check that the
+ * spans draw, and clip, exactly what the reference loop draws.
+ *
+ * @param argc The number of arguments
+ * @param argv The arguments, an optional argv[1] sets the number of draws per asset
+ * @return 0 if both ways drew the same pixels, 1 otherwise
+ */
+
+int bench_blit(int argc, char *argv[]) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 1000;
+  if (rounds < 1)
+    rounds = 1;
+  size_t size = H_RES * V_RES * VG_PIXEL_BYTES;
+  char *reference = malloc(size);
+  char *spanned = malloc(size);
+  if (reference == NULL || spanned == NULL) {
+    free(reference);
+    free(spanned);
+    return 1;
+  }
+  int mismatches = 0;
+
+  printf("%-18s %9s %8s %14s %14s %8s\n", "asset", "size", "spans", "loop (Mpx/s)", "spans (Mpx/s)", "speedup");
+  for (unsigned i = 0; i < NUM_BLIT_ASSETS; i++) {
+    const BlitAsset *asset = &assets[i];
+    xpm_image_t img;
+    uint8_t *map = load_asset(asset->asset, &img);
+    if (map == NULL) {
+      printf("%s: cannot load %s\n", asset->label, asset_name(asset->asset));
+      mismatches++;
+      continue;
+    }
+    uint16_t width = asset->width ? asset->width : img.width;
+    uint16_t height = img.height;
+    SpanMap *spans = compile_spans(map, img.width, asset->x, width, height);
+    if (spans == NULL) {
+      free(map);
+      mismatches++;
+      continue;
+    }
+    int x = (H_RES - width) / 2, y = (V_RES - height) / 2;
+    memset(reference, 0, size);
+    memset(spanned, 0, size);
+
+    uint64_t start = bench_now_us();
+    for (int r = 0; r < rounds; r++)
+      draw_pixels(map, img.width, asset->x, width, height, reference, H_RES, V_RES, x, y);
+    double loop_us = bench_now_us() - start;
+    // then across the top left and the bottom right corners, to check the clipping
+    draw_pixels(map, img.width, asset->x, width, height, reference, H_RES, V_RES, -width / 2, -height / 2);
+    draw_pixels(map, img.width, asset->x, width, height, reference, H_RES, V_RES, H_RES - width / 2, V_RES - height / 2);
+
+    vg_pack_pixmap(map, (size_t) img.width * img.height);
+    start = bench_now_us();
+    for (int r = 0; r < rounds; r++)
+      draw_spans(spans, map, spanned, H_RES, V_RES, x, y);
+    double spans_us = bench_now_us() - start;
+    draw_spans(spans, map, spanned, H_RES, V_RES, -width / 2, -height / 2);
+    draw_spans(spans, map, spanned, H_RES, V_RES, H_RES - width / 2, V_RES - height / 2);
+
+    if (memcmp(reference, spanned, size) != 0) {
+      printf("%s: spans differ from the reference loop\n", asset->label);
+      mismatches++;
+    }
+    double pixels = (double) width * height * rounds;
+    loop_us = loop_us > 0 ? loop_us : 1;
+    spans_us = spans_us > 0 ? spans_us : 1;
+    printf("%-18s %4ux%-4u %8u %14.1f %14.1f %7.1fx\n", asset->label, width, height, spans->rows[height],
+           pixels / loop_us, pixels / spans_us, loop_us / spans_us);
+
+    free_spans(spans);
+    free(map);
+  }
+
+  free(reference);
+  free(spanned);
+  return mismatches != 0;
+}
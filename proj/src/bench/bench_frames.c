@@ -0,0 +1,140 @@
+/**
+ * @file bench_frames.c
+ * @brief Frame benchmark: runs update_game() and game_state_handler() with many enemies and times each step
+ */
+
+#include "bench.h"
+#include "profile.h"
+#include "../dispatcher/dispatcher.h"
+
+#define BENCH_SEED 42        /**< Default seed of rand() */
+#define BENCH_TANK_HP 1000   /**< Tank hp restored every frame so that the game never ends */
+#define SHOOT_PERIOD 4       /**< Frames between two shots at an enemy */
+
+/** @brief Names of the timed steps, the whole frame being the last one */
+static const char *section_names[NUM_PROFILE_SECTIONS + 1] = {
+  "update_enemies", "draw_header/footer", "draw_game", "vg_flip_buffers", "frame"};
+
+/**
+ * @brief Compares two times, for qsort()
+ */
+
+static int compare_us(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * @brief Prints the mean, median, 99th percentile and maximum of some times
+ *
+ * @param name The name of what was timed
+ * @param us The times, sorted in place
+ * @param n The number of times
+ */
+
+static void print_times(const char *name, uint32_t *us, int n) {
+  uint64_t total = 0;
+  for (int i = 0; i < n; i++)
+    total += us[i];
+  qsort(us, n, sizeof(uint32_t), compare_us);
+  printf("%-20s %10.1f %8u %8u %8u\n", name, (double) total / n, us[(n - 1) / 2], us[(n - 1) * 99 / 100], us[n - 1]);
+}
+
+/**
+ * @brief Aims the crosshair at the first enemy and shoots
+ */
+
+static void shoot_first_enemy() {
+  EnemyPool *pool = get_enemy_pool();
+  if (pool->count == 0)
+    return;
+  Sprite *crosshair = get_crosshair();
+  crosshair->x = pool->x[0] + pool->width[0] / 2 - crosshair->width / 2;
+  crosshair->y = pool->y[0] + pool->height[0] / 2 - crosshair->height / 2;
+  shoot();
+}
+
+/**
+ * @brief Times game frames, step by step
+ *
+ * The game is loaded as from the menus (INITIAL then LOADING_GAME), then
+ * "waves" waves are spawned at once with increasing difficulty. Every frame
+ * runs one simulation step and draws it in INGAME, with the tank kept alive
+ * and a shot at an enemy every few frames. rand() is seeded so every run plays the same
+ * frames. The results are printed after leaving the video mode.
+ *
+ * @param argc The number of arguments
+ * @param argv The arguments: [frames] [waves] [seed]
+ * @return 0 on success, 1 otherwise
+ */
+
+int bench_frames(int argc, char *argv[]) {
+  int frames = argc > 1 ? atoi(argv[1]) : 3000;
+  int waves = argc > 2 ? atoi(argv[2]) : 10;
+  unsigned seed = argc > 3 ? (unsigned) atoi(argv[3]) : BENCH_SEED;
+  if (frames < 1)
+    frames = 1;
+  uint32_t *times[NUM_PROFILE_SECTIONS + 1];
+  for (int s = 0; s <= NUM_PROFILE_SECTIONS; s++) {
+    times[s] = malloc(frames * sizeof(uint32_t));
+    if (times[s] == NULL) {
+      while (s-- > 0)
+        free(times[s]);
+      return 1;
+    }
+  }
+
+  srand(seed);
+  vg_init(0x115);
+  init_game_state();
+  game_state_handler();
+  set_state(LOADING_GAME);
+  game_state_handler();
+  for (int i = 0; i < waves; i++) {
+    increase_difficulty();
+    spawn_enemy_wave();
+  }
+  int start_enemies = get_enemy_pool()->count;
+
+  unsigned long start_allocs = 0, start_frees = 0, end_allocs = 0, end_frees = 0;
+  bool counted = bench_alloc_counts(&start_allocs, &start_frees) == 0;
+  profile_enable(true);
+  uint64_t start = bench_now_us();
+  for (int f = 0; f < frames; f++) {
+    uint32_t sections[NUM_PROFILE_SECTIONS];
+    get_tank_model()->hp = BENCH_TANK_HP;
+    if (f % SHOOT_PERIOD == 0)
+      shoot_first_enemy();
+    uint64_t frame_start = bench_now_us();
+    update_game();
+    game_state_handler();
+    times[NUM_PROFILE_SECTIONS][f] = bench_now_us() - frame_start;
+    profile_collect(sections);
+    for (int s = 0; s < NUM_PROFILE_SECTIONS; s++)
+      times[s][f] = sections[s];
+  }
+  uint64_t elapsed = bench_now_us() - start;
+  profile_enable(false);
+  bench_alloc_counts(&end_allocs, &end_frees);
+  int end_enemies = get_enemy_pool()->count;
+  uint8_t difficulty = get_difficulty();
+
+  set_state(KILL);
+  game_state_handler();
+  cleanup_elements();
+  vg_exit();
+
+  printf("%d frames in %.1f ms, seed %u, difficulty %u, %d enemies at the start and %d at the end\n",
+         frames, elapsed / 1000.0, seed, difficulty, start_enemies, end_enemies);
+  printf("%-20s %10s %8s %8s %8s\n", "step (us)", "mean", "p50", "p99", "max");
+  for (int s = 0; s <= NUM_PROFILE_SECTIONS; s++) {
+    print_times(section_names[s], times[s], frames);
+    free(times[s]);
+  }
+  if (counted)
+    printf("heap: %lu allocations, %lu frees (%.2f allocations per frame)\n", end_allocs - start_allocs,
+           end_frees - start_frees, (double) (end_allocs - start_allocs) / frames);
+  else
+    printf("heap: allocations are only counted by the host build\n");
+  return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file bench_kernels.c
+ * @brief Row kernel benchmark: every set of blit kernels the processor runs, at sprite and screen sizes
+ */
+
+#include "bench.h"
+#include "../graphics/blit.h"
+#include "../view/game_view.h"
+#include <sys/param.h>
+
+/** @brief An area the kernels are run on, and the pixmap copied with a transparency key */
+typedef struct {
+  const char *label;
+  uint16_t width, height;
+  AssetId asset; ///< pixmap, cut to the area if larger
+} KernelArea;
+
+/** @brief A sprite restored, filled or drawn, and the whole screen */
+static const KernelArea areas[] = {
+  {"sprite", 40, 40, ASSET_VIRUS40},
+  {"screen", H_RES, V_RES, ASSET_ARENA3},
+};
+
+#define NUM_KERNEL_AREAS (sizeof(areas) / sizeof(areas[0]))
+#define NUM_KERNELS 3   /**< copy, fill and keyed copy */
+#define FILL_COLOR 0x3C7A1E /**< Colour filled with, its 3 bytes differ */
+
+/** @brief Names of the kernels, in the order they are timed */
+static const char *kernel_names[NUM_KERNELS] = {"copy", "fill", "keyed copy"};
+
+/**
+ * @brief Runs one kernel over the rows of an area, some rounds
+ *
+ * @param blit The kernels
+ * @param kernel Which one: 0 copy, 1 fill, 2 keyed copy
+ * @param dst The screen sized destination
+ * @param src The screen sized source of the copy
+ * @param map The pixmap of the keyed copy, in XPM_8_8_8
+ * @param map_width The width of the pixmap
+ * @param width The width of the area
+ * @param height The height of the area
+ * @param rounds The number of times the area is written
+ * @return The time taken, in microseconds
+ */
+
+static uint64_t run_kernel(const BlitKernels *blit, int kernel, char *dst, const char *src, const uint8_t *map,
+                           uint16_t map_width, uint16_t width, uint16_t height, int rounds) {
+  unsigned pitch = H_RES * VG_PIXEL_BYTES;
+  unsigned offset = (V_RES - height) / 2 * pitch + (H_RES - width) / 2 * VG_PIXEL_BYTES;
+  uint8_t pattern[BLIT_PATTERN_LEN];
+  blit_make_pattern(pattern, FILL_COLOR);
+  uint32_t key = xpm_transparency_color(XPM_8_8_8);
+
+  uint64_t start = bench_now_us();
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < height; i++) {
+      unsigned row = offset + i * pitch;
+      if (kernel == 0)
+        blit->copy(dst + row, src + row, width * VG_PIXEL_BYTES);
+      else if (kernel == 1)
+        blit->fill(dst + row, pattern, width * VG_PIXEL_BYTES);
+      else
+        blit->copy_keyed(dst + row, map + (size_t) i * map_width * 3, width, key);
+    }
+  }
+  return bench_now_us() - start;
+}
+
+/**
+ * @brief Measures how many megabytes per second each set of kernels writes
+ *
+ * Every kernel is run over a sprite sized and a screen sized area of buffers
+ * in system memory, the sprite enough times to write as many bytes as the
+ * screen. What each set writes is compared with what the portable set wrote.
+ *
+ * @param argc The number of arguments
+ * @param argv The arguments, an optional argv[1] sets the number of screens written per kernel
+ * @return 0 if every set wrote the same bytes as the portable one, 1 otherwise
+ */
+
+int bench_kernels(int argc, char *argv[]) {
+  int screens = argc > 1 ? atoi(argv[1]) : 200;
+  if (screens < 1)
+    screens = 1;
+  size_t size = H_RES * V_RES * VG_PIXEL_BYTES;
+  char *src = malloc(size);
+  char *dst = malloc(size);
+  char *expected = malloc(size);
+  if (src == NULL || dst == NULL || expected == NULL) {
+    free(src);
+    free(dst);
+    free(expected);
+    return 1;
+  }
+  for (size_t i = 0; i < size; i++)
+    src[i] = rand() & 0xFF;
+  blit_init();
+  printf("kernels picked: %s\n", blit_kernels()->name);
+  int mismatches = 0;
+
+  printf("%-8s %-10s %-10s %12s %10s\n", "area", "kernels", "kernel", "size", "MB/s");
+  for (unsigned a = 0; a < NUM_KERNEL_AREAS; a++) {
+    const KernelArea *area = &areas[a];
+    xpm_image_t img;
+    uint8_t *map = load_asset(area->asset, &img);
+    if (map == NULL) {
+      printf("%s: cannot load %s\n", area->label, asset_name(area->asset));
+      mismatches++;
+      continue;
+    }
+    int rounds = screens * (H_RES * V_RES / (area->width * area->height));
+    for (int kernel = 0; kernel < NUM_KERNELS; kernel++) {
+      uint16_t width = area->width, height = area->height;
+      if (kernel == 2) {
+        width = MIN(width, img.width);
+        height = MIN(height, img.height);
+      }
+      const BlitKernels *blit;
+      for (int k = 0; (blit = blit_supported_kernels(k)) != NULL; k++) {
+        memset(dst, 0, size);
+        uint64_t us = run_kernel(blit, kernel, dst, src, map, img.width, width, height, rounds);
+        if (k == 0)
+          memcpy(expected, dst, size);
+        else if (memcmp(expected, dst, size) != 0) {
+          printf("%s: %s %s differs from the portable kernel\n", area->label, blit->name, kernel_names[kernel]);
+          mismatches++;
+        }
+        double bytes = (double) width * height * VG_PIXEL_BYTES * rounds;
+        printf("%-8s %-10s %-10s %7ux%-4u %10.1f\n", area->label, blit->name, kernel_names[kernel], width, height,
+               bytes / (us > 0 ? us : 1));
+      }
+    }
+    free(map);
+  }
+
+  free(src);
+  free(dst);
+  free(expected);
+  return mismatches != 0;
+}
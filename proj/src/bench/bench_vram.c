@@ -0,0 +1,319 @@
+/**
+ * @file bench_vram.c
+ * @brief VRAM benchmark: composing frames in the VRAM pages versus in system memory uploaded on flip
+ */
+
+#include "bench.h"
+#include "../graphics/blit.h"
+#include "../view/game_view.h"
+
+#define VRAM_SPRITES 64    /**< Sprites drawn per frame in the "sprites" scene */
+#define VRAM_SEED 42       /**< Seed of the sprite positions */
+
+#ifndef VG_RGB565
+/** @brief What a frame redraws */
+enum VramScene {
+  SCENE_FULL,    ///< the background changed: the whole screen is restored
+  SCENE_SPRITES, ///< the sprites of the last frame are erased and drawn elsewhere
+  NUM_SCENES
+};
+
+/** @brief Names of the scenes, in the order they are timed */
+static const char *scene_names[NUM_SCENES] = {"full", "sprites"};
+
+/** @brief What the VRAM window saw during a run */
+typedef struct {
+  uint64_t us;
+  unsigned long read, written; ///< bytes read from and written to VRAM
+} VramRun;
+
+/** @brief The frames of a run: a background, a sprite and where it is drawn */
+typedef struct {
+  enum VramScene scene;
+  int frames;
+  const char *background;     ///< the background, in system memory
+  const uint8_t *map;         ///< the sprite, in XPM_8_8_8
+  uint16_t width, height;     ///< of the sprite
+  const int16_t (*pos)[VRAM_SPRITES][2]; ///< the x and y of every sprite of every frame
+} VramFrames;
+
+#ifdef LCOM_HOST
+/* The host maps VRAM as ordinary memory. To simulate an uncached window every
+ * read flushes its line first and waits, so it goes to memory, and every
+ * write flushes its line after, so it does not stay in the cache. */
+
+/**
+ * @brief Reads 4 bytes of the simulated uncached VRAM window
+ */
+
+static uint32_t window_read(const char *p) {
+  uint32_t word;
+  __asm__ volatile("clflush %0\n\tmfence" : : "m"(*p) : "memory");
+  memcpy(&word, p, 4);
+  return word;
+}
+
+/**
+ * @brief Writes up to 4 bytes to the simulated uncached VRAM window
+ */
+
+static void window_write(char *p, const void *src, unsigned n) {
+  memcpy(p, src, n);
+  __asm__ volatile("clflush %0" : : "m"(*p) : "memory");
+}
+#else
+
+/**
+ * @brief Reads 4 bytes of VRAM
+ */
+
+static uint32_t window_read(const char *p) {
+  uint32_t word;
+  memcpy(&word, (const void *) p, 4);
+  return word;
+}
+
+/**
+ * @brief Writes up to 4 bytes to VRAM
+ */
+
+static void window_write(char *p, const void *src, unsigned n) {
+  memcpy(p, src, n);
+}
+#endif
+
+/**
+ * @brief Copies a rectangle between two VRAM pages, 4 bytes at a time
+ *
+ * This is the restore of a double buffer from the arena buffer when both
+ * were VRAM pages. The last bytes of a row are copied again from 4 bytes
+ * before its end.
+ */
+
+static void window_copy_rect(char *dst, const char *src, int x, int y, int width, int height, VramRun *run) {
+  unsigned pitch = H_RES * VG_PIXEL_BYTES, len = width * VG_PIXEL_BYTES;
+  for (int row = 0; row < height; row++) {
+    unsigned offset = (y + row) * pitch + x * VG_PIXEL_BYTES;
+    for (unsigned i = 0; i < len; i += 4) {
+      unsigned at = i + 4 <= len ? i : len - 4;
+      uint32_t word = window_read(src + offset + at);
+      window_write(dst + offset + at, &word, 4);
+    }
+  }
+  run->read += (unsigned long) len * height;
+  run->written += (unsigned long) len * height;
+}
+
+/**
+ * @brief Draws a sprite into a VRAM page, pixel by pixel
+ */
+
+static void window_draw_sprite(char *page, const VramFrames *frames, int x, int y, VramRun *run) {
+  uint32_t key = xpm_transparency_color(XPM_8_8_8);
+  for (int i = 0; i < frames->height; i++) {
+    const uint8_t *src = frames->map + (size_t) i * frames->width * 3;
+    char *dst = page + ((y + i) * H_RES + x) * VG_PIXEL_BYTES;
+    for (int j = 0; j < frames->width; j++, src += 3, dst += VG_PIXEL_BYTES) {
+      uint32_t color = src[0] | (src[1] << 8) | (src[2] << 16);
+      if (color == key)
+        continue;
+      char pixel[VG_PIXEL_BYTES];
+      vg_pack_pixel(pixel, color);
+      window_write(dst, pixel, VG_PIXEL_BYTES);
+      run->written += VG_PIXEL_BYTES;
+    }
+  }
+}
+
+/**
+ * @brief Composes the frames in VRAM, as before the shadow buffers
+ *
+ * The background is a second VRAM page, restored from by reading it.
+ *
+ * @param frames The frames
+ * @param page The VRAM page drawn on
+ * @param background The VRAM page holding the background
+ * @return What VRAM saw, and the time taken
+ */
+
+static VramRun compose_in_vram(const VramFrames *frames, char *page, char *background) {
+  VramRun run = {0, 0, 0};
+  uint64_t start = bench_now_us();
+  for (int f = 0; f < frames->frames; f++) {
+    if (frames->scene == SCENE_FULL)
+      window_copy_rect(page, background, 0, 0, H_RES, V_RES, &run);
+    else if (f > 0) {
+      for (int i = 0; i < VRAM_SPRITES; i++)
+        window_copy_rect(page, background, frames->pos[f - 1][i][0], frames->pos[f - 1][i][1],
+                         frames->width, frames->height, &run);
+    }
+    for (int i = 0; i < VRAM_SPRITES; i++)
+      window_draw_sprite(page, frames, frames->pos[f][i][0], frames->pos[f][i][1], &run);
+  }
+  run.us = bench_now_us() - start;
+  return run;
+}
+
+/**
+ * @brief Streams a rectangle of a buffer to the same place of a VRAM page
+ */
+
+static void upload_rect(char *page, const char *buffer, int x, int y, int width, int height, VramRun *run) {
+  const BlitKernels *blit = blit_kernels();
+  unsigned pitch = H_RES * VG_PIXEL_BYTES, offset = y * pitch + x * VG_PIXEL_BYTES;
+  if (width == H_RES)
+    blit->stream(page + offset, buffer + offset, pitch * height);
+  else {
+    for (int row = 0; row < height; row++, offset += pitch)
+      blit->stream(page + offset, buffer + offset, width * VG_PIXEL_BYTES);
+  }
+  run->written += (unsigned long) width * height * VG_PIXEL_BYTES;
+}
+
+/**
+ * @brief Composes the frames in system memory and uploads what changed, as vg_flip_buffers() does
+ *
+ * @param frames The frames
+ * @param page The VRAM page shown
+ * @param buffer The buffer drawn on, in system memory
+ * @return What VRAM saw, and the time taken
+ */
+
+static VramRun compose_in_memory(const VramFrames *frames, char *page, char *buffer) {
+  VramRun run = {0, 0, 0};
+  const BlitKernels *blit = blit_kernels();
+  uint32_t key = xpm_transparency_color(XPM_8_8_8);
+  unsigned pitch = H_RES * VG_PIXEL_BYTES;
+  uint64_t start = bench_now_us();
+  for (int f = 0; f < frames->frames; f++) {
+    if (frames->scene == SCENE_FULL)
+      blit->copy(buffer, frames->background, pitch * V_RES);
+    else if (f > 0) {
+      for (int i = 0; i < VRAM_SPRITES; i++) {
+        unsigned offset = frames->pos[f - 1][i][1] * pitch + frames->pos[f - 1][i][0] * VG_PIXEL_BYTES;
+        for (int row = 0; row < frames->height; row++, offset += pitch)
+          blit->copy(buffer + offset, frames->background + offset, frames->width * VG_PIXEL_BYTES);
+      }
+    }
+    for (int i = 0; i < VRAM_SPRITES; i++) {
+      char *dst = buffer + frames->pos[f][i][1] * pitch + frames->pos[f][i][0] * VG_PIXEL_BYTES;
+      for (int row = 0; row < frames->height; row++, dst += pitch)
+        blit->copy_keyed(dst, frames->map + (size_t) row * frames->width * 3, frames->width, key);
+    }
+
+    if (frames->scene == SCENE_FULL)
+      upload_rect(page, buffer, 0, 0, H_RES, V_RES, &run);
+    else {
+      for (int i = 0; i < VRAM_SPRITES; i++) {
+        if (f > 0)
+          upload_rect(page, buffer, frames->pos[f - 1][i][0], frames->pos[f - 1][i][1], frames->width,
+                      frames->height, &run);
+        upload_rect(page, buffer, frames->pos[f][i][0], frames->pos[f][i][1], frames->width, frames->height, &run);
+      }
+    }
+    blit->stream_fence();
+  }
+  run.us = bench_now_us() - start;
+  return run;
+}
+
+/**
+ * @brief Prints a run, per frame
+ */
+
+static void print_run(const char *scene, const char *where, const VramRun *run, int frames) {
+  printf("%-8s %-8s %10.1f %10.1f %10.1f\n", scene, where, (double) run->us / frames,
+         run->read / 1024.0 / frames, run->written / 1024.0 / frames);
+}
+
+#endif
+
+/**
+ * @brief Measures the time a frame takes composed in VRAM and composed in system memory
+ *
+ * Each scene is played twice from the same sprite positions: composed in a
+ * VRAM page, restoring from a second page holding the background, and
+ * composed in a buffer in system memory whose changed regions are streamed
+ * to the page. The page must hold the same pixels after both. On MINIX the
+ * pages are the real VRAM; the host build simulates an uncached window.
+ *
+ * @param argc The number of arguments
+ * @param argv The arguments, an optional argv[1] sets the number of frames per scene
+ * @return 0 if both ways wrote the same pixels, 1 otherwise
+ */
+
+int bench_vram(int argc, char *argv[]) {
+#ifdef VG_RGB565
+  printf("vram: compares 24 bit compositing, build without VG_RGB565\n");
+  return 1;
+#else
+  int num_frames = argc > 1 ? atoi(argv[1]) : 30;
+  if (num_frames < 1)
+    num_frames = 1;
+  size_t size = H_RES * V_RES * VG_PIXEL_BYTES;
+  xpm_image_t background_img, sprite_img;
+  uint8_t *background = load_asset(ASSET_MAIN_MENU, &background_img);
+  uint8_t *sprite = load_asset(ASSET_VIRUS40, &sprite_img);
+  char *buffer = malloc(size);
+  char *expected = malloc(size);
+  int16_t (*pos)[VRAM_SPRITES][2] = malloc(num_frames * sizeof(*pos));
+  if (background == NULL || sprite == NULL || buffer == NULL || expected == NULL || pos == NULL ||
+      background_img.width != H_RES || background_img.height != V_RES) {
+    printf("vram: cannot load the assets or allocate the buffers\n");
+    free(background);
+    free(sprite);
+    free(buffer);
+    free(expected);
+    free(pos);
+    return 1;
+  }
+  srand(VRAM_SEED);
+  for (int f = 0; f < num_frames; f++) {
+    for (int i = 0; i < VRAM_SPRITES; i++) {
+      pos[f][i][0] = rand() % (H_RES - sprite_img.width);
+      pos[f][i][1] = rand() % (V_RES - sprite_img.height);
+    }
+  }
+
+  vg_init(0x115);
+  char *page = get_vram_page(0), *background_page = get_vram_page(1);
+  VramRun runs[NUM_SCENES][2];
+  int mismatches = 0;
+  for (int scene = 0; scene < NUM_SCENES; scene++) {
+    VramFrames frames = {scene, num_frames, (const char *) background, sprite, sprite_img.width,
+                         sprite_img.height, (const int16_t(*)[VRAM_SPRITES][2]) pos};
+    memcpy(background_page, background, size);
+    memcpy(page, background, size);
+    runs[scene][0] = compose_in_vram(&frames, page, background_page);
+    memcpy(expected, page, size);
+
+    memcpy(buffer, background, size);
+    memcpy(page, background, size);
+    runs[scene][1] = compose_in_memory(&frames, page, buffer);
+    if (memcmp(expected, page, size) != 0)
+      mismatches++;
+  }
+  vg_exit();
+
+  printf("kernels: %s, %d frames per scene, %d sprites of %ux%u\n", blit_kernels()->name, num_frames,
+         VRAM_SPRITES, sprite_img.width, sprite_img.height);
+  printf("%-8s %-8s %10s %10s %10s\n", "scene", "composed", "us/frame", "KB read", "KB written");
+  for (int scene = 0; scene < NUM_SCENES; scene++) {
+    print_run(scene_names[scene], "in VRAM", &runs[scene][0], num_frames);
+    print_run(scene_names[scene], "in RAM", &runs[scene][1], num_frames);
+  }
+  for (int scene = 0; scene < NUM_SCENES; scene++) {
+    printf("%s: %.1f us saved per frame\n", scene_names[scene],
+           ((double) runs[scene][0].us - runs[scene][1].us) / num_frames);
+  }
+  if (mismatches != 0)
+    printf("vram: the page differs between the two ways of composing\n");
+
+  free(background);
+  free(sprite);
+  free(buffer);
+  free(expected);
+  free(pos);
+  return mismatches != 0;
+#endif
+}
@@ -0,0 +1,55 @@
+/**
+ * @file profile.c
+ * @brief Timers around the main steps of a frame
+ */
+
+#include "profile.h"
+#include "bench.h"
+
+static bool enabled;                               /**< Whether the timers run */
+static uint64_t started[NUM_PROFILE_SECTIONS];     /**< Start time of each running section */
+static uint32_t elapsed[NUM_PROFILE_SECTIONS];     /**< Time spent in each section, in us */
+
+/**
+ * @brief Enables or disables the timers
+ *
+ * @param enable true to enable them
+ */
+
+void profile_enable(bool enable) {
+  enabled = enable;
+  memset(elapsed, 0, sizeof(elapsed));
+}
+
+/**
+ * @brief Starts timing a section
+ *
+ * @param section The section
+ */
+
+void profile_start(ProfileSection section) {
+  if (enabled)
+    started[section] = bench_now_us();
+}
+
+/**
+ * @brief Stops timing a section
+ *
+ * @param section The section
+ */
+
+void profile_stop(ProfileSection section) {
+  if (enabled)
+    elapsed[section] += bench_now_us() - started[section];
+}
+
+/**
+ * @brief Reads and resets the time spent in each section
+ *
+ * @param us Receives the time of each section, in microseconds
+ */
+
+void profile_collect(uint32_t *us) {
+  memcpy(us, elapsed, sizeof(elapsed));
+  memset(elapsed, 0, sizeof(elapsed));
+}
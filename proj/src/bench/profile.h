@@ -0,0 +1,42 @@
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** @defgroup profile Profile
+ * @{
+ *
+ * Timers around the main steps of a frame, read by the frames benchmark.
+ * They cost a single test while profiling is disabled, which is the default.
+ */
+
+/** @brief Steps of a frame that are timed */
+typedef enum {
+  PROFILE_UPDATE_ENEMIES, ///< update_enemies(), in a simulation step
+  PROFILE_HUD,            ///< draw_header() and draw_footer()
+  PROFILE_DRAW_GAME,      ///< draw_game(), including the HUD
+  PROFILE_FLIP,           ///< vg_flip_buffers()
+  NUM_PROFILE_SECTIONS
+} ProfileSection;
+
+/** Enables or disables the timers
+ */
+void profile_enable(bool enable);
+
+/** Starts timing a section
+ */
+void profile_start(ProfileSection section);
+
+/** Stops timing a section, adding the time since profile_start() to it
+ */
+void profile_stop(ProfileSection section);
+
+/** Copies the time spent in each section since the last call, in
+ *  microseconds, to us[NUM_PROFILE_SECTIONS] and resets it
+ */
+void profile_collect(uint32_t *us);
+
+/** @} end of profile */
+
+#endif
@@ -26,6 +26,10 @@
 #define ARROW_UP_BREAK_CODE 0xc8
 #define ARROW_DOWN_MAKE_CODE 0x50
 #define ARROW_DOWN_BREAK_CODE 0xd0
+#define ARROW_LEFT_MAKE_CODE 0x4b
+#define ARROW_LEFT_BREAK_CODE 0xcb
+#define ARROW_RIGHT_MAKE_CODE 0x4d
+#define ARROW_RIGHT_BREAK_CODE 0xcd
 #define A_MAKE_CODE 0x1e
 #define A_BREAK_CODE 0x9e
 #define B_MAKE_CODE 0x30
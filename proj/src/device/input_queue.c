@@ -0,0 +1,56 @@
+/**
+ * @file input_queue.c
+ * @brief Bounded single-producer single-consumer queue of input events
+ *
+ * The interrupt handlers are the only producer and the dispatcher the only
+ * consumer, so neither needs a lock: the producer alone writes the tail and
+ * the consumer alone writes the head. An event is written before the tail is
+ * published with release ordering, and read after the tail is loaded with
+ * acquire ordering; the head is published the same way once the event is
+ * released, so its slot is not reused while it is being read.
+ */
+
+#include "input_queue.h"
+#include <stdatomic.h>
+
+static InputEvent events[INPUT_QUEUE_SIZE]; /**< The ring, indexed modulo its size */
+static atomic_uint head;                    /**< Next event to take, written by the consumer */
+static atomic_uint tail;                    /**< Next free slot, written by the producer */
+
+/**
+ * @brief Queues an event
+ *
+ * @param event The event, copied
+ * @return true if it was queued, false if the queue is full
+ */
+
+bool input_queue_push(const InputEvent *event) {
+  unsigned t = atomic_load_explicit(&tail, memory_order_relaxed);
+  if (t - atomic_load_explicit(&head, memory_order_acquire) == INPUT_QUEUE_SIZE)
+    return false;
+  events[t % INPUT_QUEUE_SIZE] = *event;
+  atomic_store_explicit(&tail, t + 1, memory_order_release);
+  return true;
+}
+
+/**
+ * @brief Gets the oldest event without taking it
+ *
+ * @return The event, valid until input_queue_pop(), NULL if the queue is empty
+ */
+
+const InputEvent *input_queue_front() {
+  unsigned h = atomic_load_explicit(&head, memory_order_relaxed);
+  if (h == atomic_load_explicit(&tail, memory_order_acquire))
+    return NULL;
+  return &events[h % INPUT_QUEUE_SIZE];
+}
+
+/**
+ * @brief Takes the oldest event, freeing its slot for the producer
+ */
+
+void input_queue_pop() {
+  unsigned h = atomic_load_explicit(&head, memory_order_relaxed);
+  atomic_store_explicit(&head, h + 1, memory_order_release);
+}
@@ -0,0 +1,33 @@
+#ifndef __INPUT_QUEUE_H
+#define __INPUT_QUEUE_H
+
+#include <lcom/lcf.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define INPUT_QUEUE_SIZE 256 /**< Events the queue holds, a power of two */
+
+/** @brief A complete keyboard scancode or mouse packet, stamped with the time it was read */
+typedef struct {
+  uint64_t time_us;     /**< timer_clock_us() when the last byte was read */
+  bool is_mouse;
+  bool is_make;         /**< Keyboard: make or break code */
+  uint8_t size;         /**< Keyboard: 1, or 2 after the 0xE0 prefix */
+  uint8_t bytes[2];     /**< Keyboard: the scancode bytes */
+  struct packet packet; /**< Mouse: the packet */
+} InputEvent;
+
+/** Producer side, the interrupt handlers: queues a copy of the event, returns
+ *  false if the queue is full
+ */
+bool input_queue_push(const InputEvent *event);
+
+/** Consumer side, the dispatcher: the oldest event, NULL if the queue is empty
+ */
+const InputEvent *input_queue_front();
+
+/** Consumer side: releases the event returned by input_queue_front()
+ */
+void input_queue_pop();
+
+#endif
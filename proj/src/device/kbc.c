@@ -0,0 +1,72 @@
+/**
+ * @file kbc.c
+ * @brief Non-blocking read path of the KBC, shared by the keyboard and the mouse
+ *
+ * Both interrupt handlers drain the output buffer: every byte waiting is read
+ * and handed to the keyboard or the mouse decoder by the AUX bit of the status
+ * read with it, whatever IRQ line was raised. The handlers never wait for a
+ * byte nor print, so a burst of input costs one status and one data read per
+ * byte. The scancodes and packets decoded are stamped with the time and pushed
+ * to the input queue, which the dispatcher drains once per timer tick.
+ */
+
+#include "kbc.h"
+#include "keyboard.h"
+#include "mouse.h"
+#include "timer.h"
+
+static unsigned dropped_bytes; /**< Bytes discarded by kbc_drain() */
+
+/**
+ * @brief Drains the KBC output buffer
+ *
+ * The status register is read before each byte; the draining stops as soon as
+ * the output buffer is empty, or after KBC_MAX_DRAIN bytes. Bytes received
+ * with a parity or timeout error are read, to free the buffer, and dropped.
+ *
+ * @return The number of bytes read from the output buffer, -1 if a port could not be read
+ */
+
+int kbc_drain() {
+  int count = 0;
+  for (; count < KBC_MAX_DRAIN; count++) {
+    uint8_t status, byte;
+    if (util_sys_inb(KBC_ST_REG, &status) != 0)
+      return -1;
+    if (!(status & KBC_ST_OBF))
+      break;
+    if (util_sys_inb(KBC_OUT_BUF, &byte) != 0)
+      return -1;
+    if (status & (KBC_ST_PAR_ERR | KBC_ST_TO_ERR)) {
+      dropped_bytes++;
+      continue;
+    }
+
+    InputEvent event;
+    bool complete;
+    if (status & KBC_ST_AUX) {
+      event.is_mouse = true;
+      complete = mouse_decode_byte(byte, &event.packet);
+    }
+    else {
+      event.is_mouse = false;
+      complete = kbd_decode_byte(byte, &event.is_make, &event.size, event.bytes);
+    }
+    if (complete) {
+      event.time_us = timer_clock_us();
+      if (!input_queue_push(&event))
+        dropped_bytes++;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief Gets the number of bytes dropped by kbc_drain()
+ *
+ * @return The bytes received with an error, or completing an event the input queue had no room for
+ */
+
+unsigned kbc_dropped_bytes() {
+  return dropped_bytes;
+}
@@ -0,0 +1,22 @@
+#ifndef __KBC_H
+#define __KBC_H
+
+#include <lcom/lcf.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "i8042.h"
+#include "input_queue.h"
+
+#define KBC_MAX_DRAIN 64 /**< Bytes one kbc_drain() reads at most, should the OBF stay set */
+
+/** Reads every byte waiting in the KBC output buffer without waiting, routes it
+ *  by the AUX bit, decodes it and pushes the complete events to the input
+ *  queue; returns the number of bytes read
+ */
+int kbc_drain();
+
+/** Bytes dropped so far: received with a parity or timeout error, or completing an event the input queue had no room for
+ */
+unsigned kbc_dropped_bytes();
+
+#endif
@@ -6,12 +6,13 @@
 
 #include <lcom/lcf.h>
 #include "keyboard.h"
+#include "kbc.h"
 
 int hook_id = 1; /**< @brief Hook ID for keyboard interrupts */
-uint8_t keyboard_data; /**< @brief Data read from the keyboard */
 uint8_t kbd_status_byte; /**< @brief Status byte from the keyboard controller */
-bool discard_keyboard_data = false; /**< @brief Flag to discard erroneous keyboard data */
-bool skip_print = false; /**< @brief Flag to skip printing of scancodes */
+static bool prefix_pending = false; /**< @brief Whether a 0xE0 prefix waits for the rest of its scancode */
+static uint32_t held_keys[8]; /**< @brief Bit per key, set from its make code to its break code */
+static uint32_t pressed_keys[8]; /**< @brief Bit per key pressed since kbd_clear_pressed() */
 
 /**
  * @brief Subscribes keyboard interrupts.
@@ -76,100 +77,87 @@ uint8_t (kbc_read_cmd)(){
 }
 
 /**
- * @brief Checks if the keyboard status byte is valid.
- * 
- * @param kbd_status_byte Status byte to be checked.
- * @return True if valid, false otherwise.
+ * @brief Keyboard interrupt handler.
+ *
+ * Drains the KBC output buffer (see kbc_drain()), without waiting for bytes.
  */
 
-bool is_valid_kb_st(uint8_t kbd_status_byte){
-    if (kbd_status_byte & KBC_ST_PAR_ERR){
-        printf("parity error \n");
+void (kbc_ih)(){
+    kbc_drain();
+}
+
+/**
+ * @brief Decodes a keyboard byte.
+ *
+ * A 0xE0 prefix is kept until the byte that follows it, which completes a
+ * scancode of 2 bytes.
+ *
+ * @param byte The byte read from the KBC.
+ * @param is_make Set to whether the scancode is a make code.
+ * @param size Set to the size of the scancode.
+ * @param bytes Set to the bytes of the scancode.
+ * @return True if the byte completed a scancode, false otherwise.
+ */
+
+bool kbd_decode_byte(uint8_t byte, bool* is_make, uint8_t* size, uint8_t* bytes){
+    if (byte == SCANCODE_PREFIX){ // the next byte completes the scancode
+        prefix_pending = true;
         return false;
     }
-    if (kbd_status_byte & KBC_ST_TO_ERR){
-        printf("timeout error \n");
-        return false;
+    if (prefix_pending){
+        bytes[0] = SCANCODE_PREFIX;
+        bytes[1] = byte;
+        *size = 2;
+        prefix_pending = false;
     }
-    if (kbd_status_byte & KBC_ST_AUX){
-        printf("mouse keyboard_data error \n");
-        return false;
+    else {
+        bytes[0] = byte;
+        *size = 1;
     }
+    *is_make = !(byte & BREAK_BIT); // if the msb bit is 1 its a breakcode
     return true;
 }
 
 /**
- * @brief Reads a value from the KBC output buffer.
- * 
- * @return 0 on success, non-zero otherwise.
+ * @brief Updates the held key table with a scancode.
+ *
+ * A key is its make code, with BREAK_BIT set if it came after the 0xE0 prefix,
+ * so the arrows and the keypad keys they share codes with are told apart.
+ * A make code also marks the key as pressed, so a key released before the
+ * next simulation step still counts once.
+ *
+ * @param make Whether the scancode is a make code.
+ * @param size The size of the scancode.
+ * @param bytes The bytes of the scancode.
  */
 
-int (kbc_read_value)(){
-    uint8_t attempts = 10;
-    while( attempts > 0 ) {
-        if(util_sys_inb(KBC_ST_REG, &kbd_status_byte) != 0){
-            printf("error reading status \n");
-            return -1;
-        };
-        if( kbd_status_byte & KBC_ST_OBF ) {
-            if (util_sys_inb(KBC_OUT_BUF, &keyboard_data) != 0){
-                printf("error reading kbc output buffer \n");
-                return -1;
-            };
-            if (!is_valid_kb_st(kbd_status_byte)){
-                printf("invalid status \n");
-                return -1;
-            }
-            return 0;
-        }
-        tickdelay(micros_to_ticks(DELAY_US));
-        attempts--;
+void kbd_track_key(bool make, uint8_t size, const uint8_t* bytes){
+    uint8_t code = bytes[size - 1] & ~BREAK_BIT;
+    uint8_t key = size == 2 ? KEY_E0(code) : code;
+    uint32_t bit = (uint32_t) 1 << (key % 32);
+    if (make){
+        held_keys[key / 32] |= bit;
+        pressed_keys[key / 32] |= bit;
     }
-    printf ("timed out! \n");
-    return 1;
+    else
+        held_keys[key / 32] &= ~bit;
 }
 
 /**
- * @brief Keyboard interrupt handler.
+ * @brief Checks whether a key is down.
+ *
+ * @param key The make code of the key, or KEY_E0() of it.
+ * @return True if the key is held, or was pressed since kbd_clear_pressed().
  */
 
-void (kbc_ih)(){
-    if (kbc_read_value() != 0){
-        printf("error reading kbc obf byte");
-        discard_keyboard_data = true;
-    };
+bool kbd_key_down(uint8_t key){
+    return ((held_keys[key / 32] | pressed_keys[key / 32]) & ((uint32_t) 1 << (key % 32))) != 0;
 }
 
 /**
- * @brief Processes scancodes.
- * 
- * @param is_make Pointer to a boolean that indicates if it is a make code.
- * @param size Pointer to the size of the scancode.
- * @param bytes Pointer to the array of scancode bytes.
+ * @brief Forgets the keys that were pressed, keeping the ones still held.
  */
 
-void process_scancode(bool* is_make,uint8_t* size, uint8_t* bytes){
-    if (keyboard_data == SCANCODE_PREFIX){ // this means the scancode will have 2 bytes
-        bytes[0] = keyboard_data;    // set the 1st byte to 0xE0
-        skip_print = true;
-        *size = 2;
-    }
-    else {    // process just 1 byte
-        if(*size == 2){
-            bytes[1] = keyboard_data;  // set the 2nd byte to the value read by the ih
-            if (keyboard_data & BREAK_BIT) // if the msb bit is 1 its a breakcode
-                *is_make = false;
-            else 
-                *is_make = true;
-            skip_print = false;
-        }
-        else{
-            bytes[0] = keyboard_data;
-            
-            if (keyboard_data & BREAK_BIT)
-                *is_make = false;
-            else 
-                *is_make = true;
-            }
-    }
+void kbd_clear_pressed(){
+    memset(pressed_keys, 0, sizeof(pressed_keys));
 }
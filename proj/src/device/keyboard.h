@@ -15,13 +15,20 @@ uint8_t (kbc_read_cmd)();
 
 void (kbc_write_cmd)(uint8_t cmd);
 
-int (kbc_read_value)();
-
 void (kbc_ih)();
 
-bool is_valid_kb_st(uint8_t stat);
+bool kbd_decode_byte(uint8_t byte, bool* is_make, uint8_t* size, uint8_t* bytes);
+
+#define KEY_E0(code) ((code) | BREAK_BIT) /**< Key of a make code sent after the 0xE0 prefix */
+
+/** Updates the held key table with a make or break code */
+void kbd_track_key(bool make, uint8_t size, const uint8_t* bytes);
+
+/** Whether a key, a make code or KEY_E0() of one, is held or was pressed since kbd_clear_pressed() */
+bool kbd_key_down(uint8_t key);
 
-void process_scancode(bool* is_make,uint8_t* size, uint8_t* bytes);
+/** Forgets the keys pressed and released again, once they were acted upon */
+void kbd_clear_pressed();
 
 #endif
 
@@ -5,14 +5,15 @@
 
 #include "mouse.h"
 #include "keyboard.h"
+#include "kbc.h"
 #include <lcom/lcf.h>
 
 
 int mouse_hook_id = 5; /**< @brief Hook ID for mouse interrupts */
 uint8_t mouse_status_byte; /**< @brief Status byte from the mouse controller */
-uint8_t mouse_data; /**< @brief Data read from the mouse */
-bool discard_mouse_data; /**< @brief Flag to discard erroneous mouse data */
-uint8_t mouse_count = 0; /**< @brief Counter for mouse packets */
+uint8_t mouse_data; /**< @brief Data read from the mouse, for command replies */
+static uint8_t packet_bytes[3]; /**< @brief Bytes of the packet being received */
+static uint8_t packet_count = 0; /**< @brief Number of bytes of the packet received so far */
 int x_sum = 0; /**< @brief Sum of X movements */
 int y_sum = 0; /**< @brief Sum of Y movements */
 MouseState currentState = START; /**< @brief Current state of the mouse state machine */
@@ -66,6 +67,9 @@ bool(is_valid_m_st)(uint8_t mouse_status_byte) {
 
 /**
  * @brief Reads a byte from the KBC output buffer for the mouse.
+ *
+ * Polls the output buffer, waiting between attempts, so it is only used for
+ * the replies to mouse commands; the interrupt handler never waits.
  * 
  * @return 0 on success, non-zero otherwise.
  */
@@ -97,71 +101,45 @@ int(m_read_obf_byte)() {
 
 /**
  * @brief Mouse interrupt handler.
+ *
+ * Drains the KBC output buffer (see kbc_drain()), without waiting for bytes.
  */
 
 void(mouse_ih)() {
-  if (m_read_obf_byte() != 0) {
-    discard_mouse_data = true;
-    printf("error reading reading kbc obf byte");
-  }
+  kbc_drain();
 }
 
 /**
- * @brief Handles mouse packets.
+ * @brief Decodes a mouse byte.
+ *
+ * The first byte of a packet always has bit 3 set; a byte without it where a
+ * packet should start is dropped, so the decoder finds the packets again
+ * after losing a byte.
  * 
- * @param pp Pointer to the packet structure to be filled.
- * @return 0 on success, non-zero otherwise.
+ * @param byte The byte read from the KBC.
+ * @param pp Filled with the packet when the byte completes one.
+ * @return True if the byte completed a packet, false otherwise.
  */
 
-int(mouse_packet_handler)(struct packet *pp) {
-  switch (mouse_count) {
-    case 0:
-      if (!(mouse_data & BIT(3))) {
-        printf("KBC is not syncd with the mouse, byte discarded. \n");
-        discard_mouse_data = true;
-        break;
-      }
-      else {
-        pp->bytes[0] = mouse_data;
-        pp->lb = (mouse_data & LEFT_BUTTON);
-        pp->rb = (mouse_data & RIGHT_BUTTON);
-        pp->mb = (mouse_data & MIDDLE_BUTTON);
-        pp->x_ov = (mouse_data & MOUSE_X_OVFL);
-        pp->y_ov = (mouse_data & MOUSE_Y_OVFL);
-      }
-      mouse_count++;
-      break;
-    case 1:
-      pp->bytes[1] = mouse_data;
-      if (pp->bytes[0] & MSB_X_DELTA) {
-        pp->delta_x = 0xFF00;
-        pp->delta_x |= mouse_data;
-      }
-      else {
-        pp->delta_x &= 0x0000;
-        pp->delta_x |= mouse_data;
-      }
-      mouse_count++;
-      break;
-    case 2:
-      pp->bytes[2] = mouse_data;
-      if (pp->bytes[0] & MSB_Y_DELTA) {
-        pp->delta_y = 0xFF00;
-        pp->delta_y |= mouse_data;
-      }
-      else {
-        pp->delta_y &= 0x0000;
-        pp->delta_y |= mouse_data;
-      }
-      mouse_count++;
-      break;
-
-    default:
-      mouse_count = 0;
-      break;
-  }
-
-  return 0;
+bool(mouse_decode_byte)(uint8_t byte, struct packet *pp) {
+  if (packet_count == 0 && !(byte & BIT(3)))
+    return false;
+  packet_bytes[packet_count++] = byte;
+  if (packet_count < 3)
+    return false;
+  packet_count = 0;
+
+  uint8_t first = packet_bytes[0];
+  for (int i = 0; i < 3; i++)
+    pp->bytes[i] = packet_bytes[i];
+  pp->lb = first & LEFT_BUTTON;
+  pp->rb = first & RIGHT_BUTTON;
+  pp->mb = first & MIDDLE_BUTTON;
+  pp->x_ov = first & MOUSE_X_OVFL;
+  pp->y_ov = first & MOUSE_Y_OVFL;
+  pp->delta_x = (first & MSB_X_DELTA) ? (int16_t) (0xFF00 | packet_bytes[1]) : packet_bytes[1];
+  pp->delta_y = (first & MSB_Y_DELTA) ? (int16_t) (0xFF00 | packet_bytes[2]) : packet_bytes[2];
+  return true;
 }
 
 /**
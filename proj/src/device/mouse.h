@@ -25,7 +25,7 @@ int (m_read_obf_byte)();
 
 void (mouse_ih)();
 
-int (mouse_packet_handler)(struct packet *pp);
+bool (mouse_decode_byte)(uint8_t byte, struct packet *pp);
 
 int (kbc_issue_mouse_cmd)(uint8_t cmd);
 
@@ -7,8 +7,12 @@
 #include <lcom/timer.h>
 
 #include <stdint.h>
+#ifdef __minix
+#  include <minix/minlib.h>
+#endif
 
 #include "i8254.h"
+#include "timer.h"
 
 int timer0_hook_id = 0; /**< @brief Hook ID for timer interrupts */
 int timer_counter = 0; /**< @brief Counter for timer interrupts */
@@ -135,3 +139,43 @@ int (timer_display_conf)(uint8_t timer, uint8_t st,
   return timer_print_config(timer,field,config);
 }
 
+
+/**
+ * @brief Reads the time stamp counter.
+ * 
+ * Only MINIX tells the frequency of the counter, through tsc_get_khz().
+ * 
+ * @param us Pointer to store the time, in microseconds.
+ * @return 0 on success, 1 if the counter is not available.
+ */
+
+int timer_read_tsc_us(uint64_t *us) {
+#ifdef __minix
+  u32_t khz = tsc_get_khz();
+  if (khz != 0) {
+    u64_t tsc;
+    read_tsc_64(&tsc);
+    *us = tsc / khz * 1000 + tsc % khz * 1000 / khz;
+    return 0;
+  }
+#endif
+  return 1;
+}
+
+/**
+ * @brief Gets the time the game runs on.
+ * 
+ * MINIX merges the timer interrupts that arrive while a frame is still being
+ * drawn into a single notification, so counting them loses time whenever a
+ * frame is late. The time stamp counter does not, and is used when available.
+ * Otherwise, as in the host build, time is counted in timer interrupts.
+ * 
+ * @return The time in microseconds.
+ */
+
+uint64_t timer_clock_us() {
+  uint64_t us;
+  if (timer_read_tsc_us(&us) == 0)
+    return us;
+  return (uint64_t) timer_counter * 1000000 / TIMER_IRQ_RATE;
+}
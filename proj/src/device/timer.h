@@ -0,0 +1,19 @@
+#ifndef __CLOCK_TIMER_H
+#define __CLOCK_TIMER_H
+
+#include <lcom/lcf.h>
+#include <lcom/timer.h>
+#include <stdint.h>
+
+#define TIMER_IRQ_RATE 60 /**< @brief Timer 0 interrupts per second, LCF's default */
+
+/** Reads the time stamp counter in microseconds, returns 1 if it is not available
+ */
+int timer_read_tsc_us(uint64_t *us);
+
+/** Time since boot in microseconds, read from the time stamp counter when
+ *  possible and counted in timer interrupts otherwise
+ */
+uint64_t timer_clock_us();
+
+#endif
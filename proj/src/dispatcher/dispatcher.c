@@ -4,30 +4,172 @@
  */
 
 #include "dispatcher.h"
+#include <sys/param.h>
 
 /** @brief Pointer to the current menu being displayed. */
 static Menu *current_menu = NULL;
 
+/** @brief Time not simulated yet, less than a step once the steps due have run. */
+static uint32_t sim_accumulator_us = 0;
+
+/** @brief Clock of the last call to timer_state_handler(). */
+static uint64_t last_clock_us = 0;
+
+/**
+ * @brief Makes a menu the current one, as it was when first shown.
+ * 
+ * @param menu Pointer to the menu, built once by load_menus().
+ */
+static void open_menu(Menu *menu) {
+  reset_menu(menu);
+  current_menu = menu;
+}
+
+/**
+ * @brief Advances the game by one simulation step.
+ * 
+ * Only INGAME has anything to simulate: waves are spawned, the tank moves by
+ * the keys held, the enemies move and hit the tank, the crosshair follows the cursor and the animations go
+ * on. The game timer counts these steps, SIM_RATE a second, whatever the
+ * frame rate is.
+ */
+void update_game() {
+  if (get_state() != INGAME)
+    return;
+  uint32_t timer = get_timer();
+  if ((timer + 1) % (5 * SIM_RATE) == 0) {
+    increase_difficulty();
+    spawn_enemy_wave();
+  }
+
+  move_tank();
+  profile_start(PROFILE_UPDATE_ENEMIES);
+  update_enemies();
+  profile_stop(PROFILE_UPDATE_ENEMIES);
+  update_crosshair();
+  update_animations();
+
+  increase_timer();
+  if (timer % SIM_RATE == 0)
+    increase_game_time();
+}
+
+/**
+ * @brief Hands the mouse motion and buttons coalesced so far to mouse_state_handler().
+ * 
+ * @param motion The deltas summed and the buttons or-ed of the packets since the last call, cleared.
+ * @param pending Whether any packet was coalesced, cleared.
+ */
+static void flush_mouse(struct packet *motion, bool *pending) {
+  if (!*pending)
+    return;
+  mouse_state_handler(motion);
+  memset(motion, 0, sizeof(*motion));
+  *pending = false;
+}
+
+/**
+ * @brief Handles the input queued by the interrupt handlers up to now.
+ * 
+ * Called once per timer tick, before the simulation steps. The mouse packets
+ * are coalesced: their deltas summed and their buttons or-ed, so the cursor
+ * moves, the menus are hovered and a click or a shot is made once a tick,
+ * however many packets arrived. A key repeated by the typematic rate within
+ * the tick is handled once; other scancodes are handled in order, after the
+ * motion that came before them. Events stamped after now_us wait for the next
+ * tick.
+ * 
+ * @param now_us The current time, from timer_clock_us().
+ */
+static void process_input(uint64_t now_us) {
+  struct packet motion = {0};
+  bool motion_pending = false;
+  uint8_t last_bytes[2];
+  uint8_t last_size = 0;
+  const InputEvent *event;
+
+  while ((event = input_queue_front()) != NULL && event->time_us <= now_us) {
+    if (event->is_mouse) {
+      int16_t dx = event->packet.delta_x, dy = event->packet.delta_y;
+      motion.delta_x = MAX(INT16_MIN, MIN(INT16_MAX, motion.delta_x + dx));
+      motion.delta_y = MAX(INT16_MIN, MIN(INT16_MAX, motion.delta_y + dy));
+      motion.lb |= event->packet.lb;
+      motion.rb |= event->packet.rb;
+      motion.mb |= event->packet.mb;
+      motion_pending = true;
+    }
+    else if (event->size != last_size || memcmp(event->bytes, last_bytes, event->size) != 0) {
+      flush_mouse(&motion, &motion_pending);
+      memcpy(last_bytes, event->bytes, event->size);
+      last_size = event->size;
+      kbd_state_handler(event->is_make, last_size, last_bytes);
+    }
+    input_queue_pop();
+  }
+  flush_mouse(&motion, &motion_pending);
+}
+
+/**
+ * @brief Runs the simulation steps due by now, then draws a frame.
+ * 
+ * The time elapsed since the last call is accumulated and spent in fixed
+ * steps, so a late frame makes the next one run more steps instead of slowing
+ * the game down. At most MAX_SIM_STEPS are run at once, the rest is dropped.
+ * Outside of INGAME the accumulator stays empty, so a pause is not caught up,
+ * and the keys pressed are forgotten, so they do not move the tank later.
+ * The input queued since the last call is handled first, by process_input().
+ * 
+ * @param now_us The current time, from timer_clock_us().
+ */
+void timer_state_handler(uint64_t now_us) {
+  process_input(now_us);
+  uint64_t elapsed_us = now_us - last_clock_us;
+  last_clock_us = now_us;
+  if (get_state() != INGAME) {
+    sim_accumulator_us = 0;
+    kbd_clear_pressed();
+  }
+  else {
+    if (elapsed_us > MAX_SIM_STEPS * SIM_STEP_US - sim_accumulator_us)
+      sim_accumulator_us = MAX_SIM_STEPS * SIM_STEP_US;
+    else
+      sim_accumulator_us += elapsed_us;
+    while (sim_accumulator_us >= SIM_STEP_US && get_state() == INGAME) {
+      update_game();
+      sim_accumulator_us -= SIM_STEP_US;
+    }
+  }
+  game_state_handler();
+}
 
 /**
  * @brief Handles the game state transitions and actions.
  * 
  * This function manages the various states of the game, performing actions
- * such as loading menus, updating game elements, and rendering the screen
- * based on the current state.
+ * such as loading menus and rendering the screen based on the current state.
+ * The game itself only advances in update_game(): INGAME draws the enemies
+ * between their last two steps, by the time accumulated since the last one.
  */
 void game_state_handler() {
 
   GameState game_state = get_game_state();
   State state = game_state.state;
-  uint32_t timer = game_state.timer;
 
   switch (state) {
     case INITIAL:
       load_menu_fonts();
       load_game_fonts();
       load_game_sprites();
-      current_menu = get_initial_menu();
+      if (load_menus() != 0) {
+        // the main loop stops on KILL before this handler runs again
+        printf("Cannot load the menus\n");
+        free_menus();
+        free_menu_fonts();
+        free_game_fonts();
+        set_state(KILL);
+        break;
+      }
+      open_menu(get_initial_menu());
       set_state(INITIAL_MENU);
       break;
     case INITIAL_MENU:
@@ -39,34 +181,32 @@ void game_state_handler() {
       display_menu(current_menu);
       draw_cursor();
       vg_flip_buffers();
+      prefetch_next_arena();
       break;
     case LOADING_MAIN_MENU:
-      free_menu(current_menu);
-      current_menu = get_main_menu();
+      open_menu(get_main_menu());
       display_menu(current_menu);
       set_state(MAIN_MENU);
       break;
     case LOADING_HELP:
-      free_menu(current_menu);
-      current_menu = get_help_menu();
+      open_menu(get_help_menu());
       display_menu(current_menu);
       set_state(HELP_MENU);
       break;
     case LOADING_HIGHSCORES:
-      free_menu(current_menu);
-      current_menu = get_highscores_menu();
+      open_menu(get_highscores_menu());
       display_menu(current_menu);
       set_state(HIGHSCORES_MENU);
       break;
     case LOADING_PAUSE:
-      current_menu = get_pause_menu();
+      open_menu(get_pause_menu());
       display_menu(current_menu);
       set_state(PAUSE_MENU);
       break;
     case WAITING:
       break;
     case LOADING_GAME:
-      free_menu(current_menu);
+      current_menu = NULL;
       cleanup_elements();
       create_game_elements();
       reset_game_stats(game_state);
@@ -74,28 +214,26 @@ void game_state_handler() {
       set_state(INGAME);
       break;
     case INGAME:
-      if ((timer + 1) % (5 * 30) == 0) {
-        increase_difficulty();
-        spawn_enemy_wave();
-      }
-
-      draw_game();
+      vg_set_background(get_arena_buffer());
+      profile_start(PROFILE_DRAW_GAME);
+      draw_game(sim_accumulator_us * INTERP_ONE / SIM_STEP_US);
+      profile_stop(PROFILE_DRAW_GAME);
+      profile_start(PROFILE_FLIP);
       vg_flip_buffers();
-
-      increase_timer();
-      if (timer % 30 == 0)
-        increase_game_time();
+      profile_stop(PROFILE_FLIP);
       break;
     case GAME_END:
       destroy_arena(get_current_arena());
-      current_menu = get_game_over_menu();
+      open_menu(get_game_over_menu());
       set_state(GAME_OVER);
       break;
     case KILL:
       printf("Killing game\n");
       free_menu_fonts();
       free_game_fonts();
-      free_menu(current_menu);
+      free_menus();
+      free_arenas();
+      current_menu = NULL;
 
       break;
     default:
@@ -106,11 +244,15 @@ void game_state_handler() {
 /**
  * @brief Handles keyboard input based on the current state.
  * 
+ * The held key table is updated in every state, so a key released in a menu
+ * is not still held when the game resumes.
+ * 
  * @param make True if the key was pressed, false if it was released.
  * @param size Size of the bytes array.
  * @param bytes Array containing the scancode bytes.
  */
 void kbd_state_handler(bool make, uint8_t size, uint8_t *bytes) {
+  kbd_track_key(make, size, bytes);
   State state = get_state();
   switch (state) {
     case INITIAL_MENU:
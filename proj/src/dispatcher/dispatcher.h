@@ -7,10 +7,18 @@
 #include "../view/game_view.h"
 #include "../model/game_model.h"
 #include "../device/mouse.h"
+#include "../device/input_queue.h"
 #include "../graphics/video_gr.h"
 #include "../logic/game_logic.h"
 #include "state.h"
 
+#define SIM_RATE 30                      ///< simulation steps per second
+#define SIM_STEP_US (1000000 / SIM_RATE) ///< length of a simulation step
+#define MAX_SIM_STEPS 4                  ///< steps a single frame can catch up
+
+void update_game();
+
+void timer_state_handler(uint64_t now_us);
 
 void game_state_handler();
 
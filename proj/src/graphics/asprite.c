@@ -7,57 +7,117 @@
 #include "asprite.h"
 
 /**
- * @brief Creates an animated sprite
+ * @brief Loads the frames of an animated sprite
  *
- * This function creates an animated sprite with the provided parameters.
- * It initializes the sprite with the first pixmap and allocates memory
- * for an array of pointers to store subsequent pixmaps.
+ * This function decodes every pixmap frame once and compiles its opaque
+ * spans. The resulting frames are meant to be shared by all the animated
+ * sprites that play them, so creating one of those sprites never has to
+ * parse an XPM again.
  *
- * @param aspeed The animation speed
- * @param no_pic The number of pixmap frames
- * @param pic1 The first pixmap frame
- * @param ... Additional pixmap frames (variadic arguments)
- * @return A pointer to the created animated sprite, or NULL if creation fails
+ * @param first The asset of the first frame, frame i being asset first + i
+ * @param no_pic The number of pixmap frames, at least 1
+ * @return A pointer to the loaded frames, or NULL if loading fails
  */
 
 
 // Adapted from the lecture slides(https://web.fe.up.pt/~pfs/aulas/lcom2324/at/9sprites.pdf)
-AnimSprite *create_asprite(int aspeed, uint8_t no_pic, const char *pic1[], ...) {
-  AnimSprite *asp = malloc(sizeof(AnimSprite));
-  // create a standard sprite with first pixmap
-  asp->sp = create_sprite((const char**)pic1, 0, 0, 0, 0);
-  // allocate array of pointers to pixmaps
-  asp->map = malloc((no_pic) * sizeof(char *));
-  // initialize the first pixmap
-  asp->map[0] = asp->sp->map;
-
-  asp->num_fig = no_pic;
-  asp->cur_fig = 0;
-  asp->aspeed = aspeed;
-  asp->cur_aspeed = 0;
-
+AnimFrames *load_anim_frames(AssetId first, uint8_t no_pic) {
+  AnimFrames *frames = malloc(sizeof(AnimFrames));
+  if (frames == NULL)
+    return NULL;
+  // allocate arrays of pointers to pixmaps and their spans
+  frames->map = malloc((no_pic) * sizeof(uint8_t *));
+  frames->spans = malloc((no_pic) * sizeof(SpanMap *));
+  if (frames->map == NULL || frames->spans == NULL) {
+    free(frames->map);
+    free(frames->spans);
+    free(frames);
+    return NULL;
+  }
+  frames->num_fig = no_pic;
+
+  // the first pixmap sets the dimensions of every frame
+  xpm_image_t img;
+  frames->map[0] = load_asset(first, &img);
+  frames->spans[0] = frames->map[0] == NULL ? NULL : compile_spans(frames->map[0], img.width, 0, img.width, img.height);
+  if (frames->spans[0] == NULL) {
+    free(frames->map[0]);
+    free(frames->map);
+    free(frames->spans);
+    free(frames);
+    return NULL;
+  }
+  vg_pack_pixmap(frames->map[0], (size_t) img.width * img.height);
+  frames->width = img.width;
+  frames->height = img.height;
 
-  // initialize the remainder with the variable arguments
-  // iterate over the list of arguments
-  va_list ap;
-  va_start(ap, pic1);
+  // initialize the remainder with the next assets
   for (int i = 1; i < no_pic; i++) {
-    const char **tmp = va_arg(ap, const char **);
-    xpm_image_t img;
-    asp->map[i] = xpm_load(tmp, XPM_8_8_8, &img);
-    if (asp->map[i] == NULL || img.width != asp->sp->width || img.height != asp->sp->height) { // failure: release allocated memory
-      for (int j = 1; j < i; j++)
-        free(asp->map[i]);
-      free(asp->map);
-      destroy_sprite(asp->sp);
-      free(asp);
-      va_end(ap);
+    frames->map[i] = load_asset(first + i, &img);
+    frames->spans[i] = NULL;
+    if (frames->map[i] == NULL || img.width != frames->width || img.height != frames->height ||
+        (frames->spans[i] = compile_spans(frames->map[i], img.width, 0, img.width, img.height)) == NULL) { // failure: release allocated memory
+      for (int j = 0; j <= i; j++) {
+        free(frames->map[j]);
+        free_spans(frames->spans[j]);
+      }
+      free(frames->map);
+      free(frames->spans);
+      free(frames);
       return NULL;
     }
+    vg_pack_pixmap(frames->map[i], (size_t) img.width * img.height);
   }
-  va_end(ap);
 
-  return asp;
+  return frames;
+}
+
+/**
+ * @brief Frees the frames of an animated sprite
+ *
+ * Must only be called once no animated sprite is playing the frames anymore.
+ *
+ * @param frames The frames to free
+ */
+
+void free_anim_frames(AnimFrames *frames) {
+  if (frames == NULL)
+    return;
+  for (int i = 0; i < frames->num_fig; i++) {
+    free(frames->map[i]);
+    free_spans(frames->spans[i]);
+  }
+  free(frames->map);
+  free(frames->spans);
+  free(frames);
+}
+
+/**
+ * @brief Initializes an animated sprite in place
+ *
+ * The sprite starts on the first frame and only references the shared
+ * frames, so no memory is allocated.
+ *
+ * @param asp The animated sprite to initialize
+ * @param frames The shared frames to play
+ * @param aspeed The animation speed
+ * @param x The initial x position of the sprite
+ * @param y The initial y position of the sprite
+ */
+
+void init_asprite(AnimSprite *asp, const AnimFrames *frames, int aspeed, int x, int y) {
+  asp->frames = frames;
+  asp->aspeed = aspeed;
+  asp->cur_aspeed = 0;
+  asp->cur_fig = 0;
+  asp->sp.x = x;
+  asp->sp.y = y;
+  asp->sp.width = frames->width;
+  asp->sp.height = frames->height;
+  asp->sp.xspeed = 0;
+  asp->sp.yspeed = 0;
+  asp->sp.map = frames->map[0];
+  asp->sp.spans = frames->spans[0];
 }
 
 /**
@@ -78,9 +138,10 @@ int animate_asprite(AnimSprite *asp, bool destroy) {
 
   if (asp->cur_aspeed >= asp->aspeed) {
     asp->cur_aspeed = 0;
-    asp->cur_fig = (asp->cur_fig + 1) % asp->num_fig;
-    asp->sp->map = asp->map[asp->cur_fig];
-    if (destroy && asp->cur_fig == asp->num_fig - 1) {
+    asp->cur_fig = (asp->cur_fig + 1) % asp->frames->num_fig;
+    asp->sp.map = asp->frames->map[asp->cur_fig];
+    asp->sp.spans = asp->frames->spans[asp->cur_fig];
+    if (destroy && asp->cur_fig == asp->frames->num_fig - 1) {
             return 1;
         }
   }
@@ -91,28 +152,17 @@ int animate_asprite(AnimSprite *asp, bool destroy) {
 }
 
 /**
- * @brief Destroys an animated sprite
- *
- * This function frees the memory allocated for an animated sprite,
- * including its pixmaps and the sprite structure itself.
+ * @brief Draws one frame of a set of animation frames
  *
- * @param asp The animated sprite to destroy
+ * @param frames The frames
+ * @param fig The index of the frame to draw
+ * @param x The x position to draw it at
+ * @param y The y position to draw it at
+ * @return Always returns 0
  */
 
-void destroy_asprite(AnimSprite *asp) {
-    if (asp == NULL) return;
-
-    // Free all the pixmaps
-    for (int i = 0; i < asp->num_fig; i++) {
-        free(asp->map[i]);
-    }
-
-    // Free the pixmaps array
-    free(asp->map);
-
-    // Destroy the main sprite
-    destroy_sprite(asp->sp);
-
-    // Free the AnimSprite structure
-    free(asp);
+int draw_anim_frame(const AnimFrames *frames, int fig, int x, int y) {
+  draw_spans(frames->spans[fig], frames->map[fig], get_drawing_buffer(), get_h_res(), get_v_res(), x, y);
+  vg_mark_dirty(x, y, frames->width, frames->height);
+  return 0;
 }
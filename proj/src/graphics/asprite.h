@@ -6,7 +6,6 @@
 #ifndef _ASPRITE_H_
 #define _ASPRITE_H_
 
-#include <stdarg.h>
 #include "sprite.h"
 
 /** @defgroup animsprite AnimSprite
@@ -15,31 +14,50 @@
  * Animated Sprite related functions
  */
 
+/** Frames of an animated pixmap, decoded once and shared (read-only)
+ *  by every AnimSprite that plays them
+ */
+typedef struct {
+	uint16_t width, height;	///< dimensions common to every frame
+	int num_fig;		///< number of pixmaps
+	uint8_t **map;		///< pointer to array of each decoded pixmap
+	SpanMap **spans;	///< opaque spans compiled from each pixmap
+} AnimFrames;
+
 /** An Animated Sprite is a "sub-classing" of Sprites
- *  where each Sprite is manipulated using Sprite functions
+ *  where each Sprite is manipulated using Sprite functions.
+ *  It only keeps its position and the index of the current frame,
+ *  the pixmaps themselves belong to the shared AnimFrames.
  */
 typedef struct {
-	Sprite *sp;		///< pointer to first Sprite, the one with overall properties
+	Sprite sp;		///< Sprite with the overall properties, its map and spans are the current frame
+	const AnimFrames *frames; ///< shared frames being played
 	int aspeed;		///< animation speed 
 	int cur_aspeed; ///< current animation speed 
-	int num_fig; 	///< number of pixmaps 
 	int cur_fig; 	///< current pixmap 
-	unsigned char **map;     ///< pointer to array of each AnimSprite pixmaps
 } AnimSprite;
 
-/** Create an Animated Sprite from multiple pixmaps
-*   At least one pixmap must be specified.
+/** Decode multiple pixmaps once into a set of shared frames
+*   Frame i is asset "first + i", all with the same dimensions.
+*/
+AnimFrames *load_anim_frames(AssetId first, uint8_t no_pic);
+
+/** Release the pixmaps of a set of frames
+*/
+void free_anim_frames(AnimFrames *frames);
+
+/** Initialize an Animated Sprite in place, without allocating memory
 */
-AnimSprite *create_asprite(int aspeed, uint8_t no_pic, const char *pic1[], ...);
+void init_asprite(AnimSprite *asp, const AnimFrames *frames, int aspeed, int x, int y);
 
 /** Animate an Animated Sprite
 */
 int animate_asprite(AnimSprite *asp, bool destroy);
 
-/** Destroy an Animated Sprite from video memoty and
-* release all resources allocated.
+/** Draw frame "fig" of a set of frames at (x, y), for objects that keep
+*   their own animation state instead of an AnimSprite
 */
-void destroy_asprite(AnimSprite *asp);
+int draw_anim_frame(const AnimFrames *frames, int fig, int x, int y);
 
 /** @} end of sprite */
 
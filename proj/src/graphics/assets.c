@@ -0,0 +1,164 @@
+/**
+ * @file assets.c
+ * @brief The asset registry: the only file the XPM data is compiled into
+ */
+
+#include "assets.h"
+#include "baked.h"
+#include "../../assets/xpm/objects/tank1.xpm"
+#include "../../assets/xpm/objects/tank2.xpm"
+#include "../../assets/xpm/objects/tank3.xpm"
+#include "../../assets/xpm/objects/tank4.xpm"
+#include "../../assets/xpm/objects/tank5.xpm"
+#include "../../assets/xpm/objects/tank6.xpm"
+#include "../../assets/xpm/objects/tank7.xpm"
+#include "../../assets/xpm/objects/tank8.xpm"
+#include "../../assets/xpm/objects/tank9.xpm"
+#include "../../assets/xpm/objects/tank10.xpm"
+#include "../../assets/xpm/objects/tank11.xpm"
+#include "../../assets/xpm/objects/tank12.xpm"
+#include "../../assets/xpm/crosshair.xpm"
+#include "../../assets/xpm/cursor.xpm"
+#include "../../assets/xpm/objects/virus40.xpm"
+#include "../../assets/xpm/objects/virus50_1.xpm"
+#include "../../assets/xpm/objects/virus50_2.xpm"
+#include "../../assets/xpm/objects/virus50_3.xpm"
+#include "../../assets/xpm/objects/virus50_4.xpm"
+#include "../../assets/xpm/objects/virus50_5.xpm"
+#include "../../assets/xpm/explosion/explosion1.xpm"
+#include "../../assets/xpm/explosion/explosion2.xpm"
+#include "../../assets/xpm/explosion/explosion3.xpm"
+#include "../../assets/xpm/explosion/explosion4.xpm"
+#include "../../assets/xpm/explosion/explosion5.xpm"
+#include "../../assets/xpm/explosion/explosion6.xpm"
+#include "../../assets/xpm/explosion/explosion7.xpm"
+#include "../../assets/xpm/explosion/explosion8.xpm"
+#include "../../assets/xpm/explosion/explosion9.xpm"
+#include "../../assets/xpm/explosion/explosion10.xpm"
+#include "../../assets/xpm/explosion/explosion11.xpm"
+#include "../../assets/xpm/explosion/explosion12.xpm"
+#include "../../assets/xpm/explosion/explosion13.xpm"
+#include "../../assets/xpm/explosion/explosion14.xpm"
+#include "../../assets/xpm/explosion/explosion15.xpm"
+#include "../../assets/xpm/explosion/explosion16.xpm"
+#include "../../assets/xpm/explosion/explosion17.xpm"
+#include "../../assets/xpm/explosion/explosion18.xpm"
+#include "../../assets/xpm/explosion/explosion19.xpm"
+#include "../../assets/xpm/explosion/explosion20.xpm"
+#include "../../assets/xpm/arenas/arena2.xpm"
+#include "../../assets/xpm/arenas/arena3.xpm"
+#include "../../assets/xpm/arenas/arena4.xpm"
+#include "../../assets/xpm/arenas/arena5.xpm"
+#include "../../assets/xpm/menus/initial_menu.xpm"
+#include "../../assets/xpm/menus/main_menu.xpm"
+#include "../../assets/xpm/menus/help_menu.xpm"
+#include "../../assets/xpm/menus/highscores_menu.xpm"
+#include "../../assets/xpm/menus/pause_menu.xpm"
+#include "../../assets/xpm/menus/game_over_menu.xpm"
+#include "../../assets/xpm/menus/new_highscore_menu.xpm"
+#include "../../assets/xpm/text/menu_font_selected.xpm"
+#include "../../assets/xpm/text/menu_font_unselected.xpm"
+#include "../../assets/xpm/text/menu_numbers.xpm"
+#include "../../assets/xpm/text/title_font.xpm"
+#include "../../assets/xpm/text/game_letters.xpm"
+#include "../../assets/xpm/text/game_numbers.xpm"
+
+/** @brief Name and XPM of every asset */
+static const struct {
+  const char *name;
+  xpm_map_t xpm;
+} assets[NUM_ASSETS] = {
+  [ASSET_TANK1] = {"tank1", tank1_xpm},
+  [ASSET_TANK2] = {"tank2", tank2_xpm},
+  [ASSET_TANK3] = {"tank3", tank3_xpm},
+  [ASSET_TANK4] = {"tank4", tank4_xpm},
+  [ASSET_TANK5] = {"tank5", tank5_xpm},
+  [ASSET_TANK6] = {"tank6", tank6_xpm},
+  [ASSET_TANK7] = {"tank7", tank7_xpm},
+  [ASSET_TANK8] = {"tank8", tank8_xpm},
+  [ASSET_TANK9] = {"tank9", tank9_xpm},
+  [ASSET_TANK10] = {"tank10", tank10_xpm},
+  [ASSET_TANK11] = {"tank11", tank11_xpm},
+  [ASSET_TANK12] = {"tank12", tank12_xpm},
+  [ASSET_CROSSHAIR] = {"crosshair", crosshair_xpm},
+  [ASSET_CURSOR] = {"cursor", cursor_xpm},
+  [ASSET_VIRUS40] = {"virus40", virus40_xpm},
+  [ASSET_VIRUS50_1] = {"virus50_1", virus50_1_xpm},
+  [ASSET_VIRUS50_2] = {"virus50_2", virus50_2_xpm},
+  [ASSET_VIRUS50_3] = {"virus50_3", virus50_3_xpm},
+  [ASSET_VIRUS50_4] = {"virus50_4", virus50_4_xpm},
+  [ASSET_VIRUS50_5] = {"virus50_5", virus50_5_xpm},
+  [ASSET_EXPLOSION1] = {"explosion1", explosion1_xpm},
+  [ASSET_EXPLOSION2] = {"explosion2", explosion2_xpm},
+  [ASSET_EXPLOSION3] = {"explosion3", explosion3_xpm},
+  [ASSET_EXPLOSION4] = {"explosion4", explosion4_xpm},
+  [ASSET_EXPLOSION5] = {"explosion5", explosion5_xpm},
+  [ASSET_EXPLOSION6] = {"explosion6", explosion6_xpm},
+  [ASSET_EXPLOSION7] = {"explosion7", explosion7_xpm},
+  [ASSET_EXPLOSION8] = {"explosion8", explosion8_xpm},
+  [ASSET_EXPLOSION9] = {"explosion9", explosion9_xpm},
+  [ASSET_EXPLOSION10] = {"explosion10", explosion10_xpm},
+  [ASSET_EXPLOSION11] = {"explosion11", explosion11_xpm},
+  [ASSET_EXPLOSION12] = {"explosion12", explosion12_xpm},
+  [ASSET_EXPLOSION13] = {"explosion13", explosion13_xpm},
+  [ASSET_EXPLOSION14] = {"explosion14", explosion14_xpm},
+  [ASSET_EXPLOSION15] = {"explosion15", explosion15_xpm},
+  [ASSET_EXPLOSION16] = {"explosion16", explosion16_xpm},
+  [ASSET_EXPLOSION17] = {"explosion17", explosion17_xpm},
+  [ASSET_EXPLOSION18] = {"explosion18", explosion18_xpm},
+  [ASSET_EXPLOSION19] = {"explosion19", explosion19_xpm},
+  [ASSET_EXPLOSION20] = {"explosion20", explosion20_xpm},
+  [ASSET_ARENA2] = {"arena2", arena2_xpm},
+  [ASSET_ARENA3] = {"arena3", arena3_xpm},
+  [ASSET_ARENA4] = {"arena4", arena4_xpm},
+  [ASSET_ARENA5] = {"arena5", arena5_xpm},
+  [ASSET_INITIAL_MENU] = {"initial_menu", initial_menu_xpm},
+  [ASSET_MAIN_MENU] = {"main_menu", main_menu_xpm},
+  [ASSET_HELP_MENU] = {"help_menu", help_menu_xpm},
+  [ASSET_HIGHSCORES_MENU] = {"highscores_menu", highscores_menu_xpm},
+  [ASSET_PAUSE_MENU] = {"pause_menu", pause_menu_xpm},
+  [ASSET_GAME_OVER_MENU] = {"game_over_menu", game_over_menu_xpm},
+  [ASSET_NEW_HIGHSCORE_MENU] = {"new_highscore_menu", new_highscore_menu_xpm},
+  [ASSET_MENU_FONT_SELECTED] = {"menu_font_selected", menu_font_selected_xpm},
+  [ASSET_MENU_FONT_UNSELECTED] = {"menu_font_unselected", menu_font_unselected_xpm},
+  [ASSET_MENU_NUMBERS] = {"menu_numbers", menu_numbers_xpm},
+  [ASSET_TITLE_FONT] = {"title_font", title_font_xpm},
+  [ASSET_GAME_LETTERS] = {"game_letters", game_letters_xpm},
+  [ASSET_GAME_NUMBERS] = {"game_numbers", game_numbers_xpm},
+};
+
+/**
+ * @brief Gets the name of an asset
+ *
+ * The baked blob of the asset and its other derived files are named after it.
+ *
+ * @param asset The asset
+ * @return Its name, the XPM file name without extension
+ */
+
+const char *asset_name(AssetId asset) {
+  return assets[asset].name;
+}
+
+/**
+ * @brief Gets the XPM of an asset
+ *
+ * @param asset The asset
+ * @return Its XPM
+ */
+
+xpm_row_t *asset_xpm(AssetId asset) {
+  return assets[asset].xpm;
+}
+
+/**
+ * @brief Loads an asset
+ *
+ * @param asset The asset
+ * @param img The image information to fill
+ * @return The pixmap in XPM_8_8_8, or NULL on failure
+ */
+
+uint8_t *load_asset(AssetId asset, xpm_image_t *img) {
+  return load_pixmap(assets[asset].xpm, assets[asset].name, img);
+}
@@ -0,0 +1,98 @@
+#ifndef _ASSETS_H_
+#define _ASSETS_H_
+
+#include <lcom/lcf.h>
+#include <stdint.h>
+
+/** @defgroup assets Assets
+ * @{
+ *
+ * Every pixmap of the game, named by an AssetId. Their XPM data is only
+ * compiled into assets.c, and only parsed if the asset was not baked.
+ */
+
+/** An asset. Numbered frames of a sequence have consecutive ids */
+typedef enum {
+  // tank, one frame per direction
+  ASSET_TANK1,
+  ASSET_TANK2,
+  ASSET_TANK3,
+  ASSET_TANK4,
+  ASSET_TANK5,
+  ASSET_TANK6,
+  ASSET_TANK7,
+  ASSET_TANK8,
+  ASSET_TANK9,
+  ASSET_TANK10,
+  ASSET_TANK11,
+  ASSET_TANK12,
+  // crosshair and mouse cursor
+  ASSET_CROSSHAIR,
+  ASSET_CURSOR,
+  // enemies
+  ASSET_VIRUS40,
+  ASSET_VIRUS50_1,
+  ASSET_VIRUS50_2,
+  ASSET_VIRUS50_3,
+  ASSET_VIRUS50_4,
+  ASSET_VIRUS50_5,
+  // explosion animation
+  ASSET_EXPLOSION1,
+  ASSET_EXPLOSION2,
+  ASSET_EXPLOSION3,
+  ASSET_EXPLOSION4,
+  ASSET_EXPLOSION5,
+  ASSET_EXPLOSION6,
+  ASSET_EXPLOSION7,
+  ASSET_EXPLOSION8,
+  ASSET_EXPLOSION9,
+  ASSET_EXPLOSION10,
+  ASSET_EXPLOSION11,
+  ASSET_EXPLOSION12,
+  ASSET_EXPLOSION13,
+  ASSET_EXPLOSION14,
+  ASSET_EXPLOSION15,
+  ASSET_EXPLOSION16,
+  ASSET_EXPLOSION17,
+  ASSET_EXPLOSION18,
+  ASSET_EXPLOSION19,
+  ASSET_EXPLOSION20,
+  // arenas, without arena1 which no game is played in (see arena_manager.c)
+  ASSET_ARENA2,
+  ASSET_ARENA3,
+  ASSET_ARENA4,
+  ASSET_ARENA5,
+  // menu backgrounds
+  ASSET_INITIAL_MENU,
+  ASSET_MAIN_MENU,
+  ASSET_HELP_MENU,
+  ASSET_HIGHSCORES_MENU,
+  ASSET_PAUSE_MENU,
+  ASSET_GAME_OVER_MENU,
+  ASSET_NEW_HIGHSCORE_MENU,
+  // fonts
+  ASSET_MENU_FONT_SELECTED,
+  ASSET_MENU_FONT_UNSELECTED,
+  ASSET_MENU_NUMBERS,
+  ASSET_TITLE_FONT,
+  ASSET_GAME_LETTERS,
+  ASSET_GAME_NUMBERS,
+  NUM_ASSETS
+} AssetId;
+
+/** Gets the name of an asset, the XPM file name without extension
+ */
+const char *asset_name(AssetId asset);
+
+/** Gets the XPM of an asset
+ */
+xpm_row_t *asset_xpm(AssetId asset);
+
+/** Loads an asset in XPM_8_8_8, from its baked blob if there is one,
+ *  otherwise by parsing its XPM. Returns NULL on failure
+ */
+uint8_t *load_asset(AssetId asset, xpm_image_t *img);
+
+/** @} end of assets */
+
+#endif
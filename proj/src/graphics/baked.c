@@ -0,0 +1,112 @@
+/**
+ * @file baked.c
+ * @brief Implementation file for loading baked pixmaps
+ */
+
+#include "baked.h"
+
+/**
+ * @brief Reads a 16 bit little endian value
+ */
+static uint16_t get16(const uint8_t *p) {
+  return p[0] | (p[1] << 8);
+}
+
+/**
+ * @brief Reads a 32 bit little endian value
+ */
+static uint32_t get32(const uint8_t *p) {
+  return get16(p) | ((uint32_t) get16(p + 2) << 16);
+}
+
+/**
+ * @brief Loads a baked pixmap
+ *
+ * This function reads the blob written by tools/xpm_bake for the asset "name"
+ * from BAKED_ASSETS_DIR. The pixels come out exactly as xpm_load() would
+ * return them in XPM_8_8_8, so the result can be used anywhere a decoded XPM is.
+ *
+ * @param name The name of the asset (the XPM file name without extension)
+ * @param img The image information to fill
+ * @param mask If not NULL, receives the transparency mask, one bit per pixel
+ * @return The pixmap, or NULL if the blob is missing or invalid
+ */
+
+uint8_t *load_baked_pixmap(const char *name, xpm_image_t *img, uint8_t **mask) {
+  char path[256];
+  uint8_t header[BAKED_HEADER_SIZE];
+  snprintf(path, sizeof(path), "%s/%s.bin", BAKED_ASSETS_DIR, name);
+
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+    return NULL;
+  if (fread(header, 1, BAKED_HEADER_SIZE, file) != BAKED_HEADER_SIZE ||
+      memcmp(header, BAKED_MAGIC, 4) != 0 || get16(header + 4) != BAKED_VERSION) {
+    fclose(file);
+    return NULL;
+  }
+
+  uint16_t width = get16(header + 6);
+  uint16_t height = get16(header + 8);
+  uint16_t flags = get16(header + 10);
+  uint32_t baked_key = get32(header + 12);
+  size_t size = (size_t) width * height * 3;
+  size_t mask_size = (size_t) ((width + 7) / 8) * height;
+
+  uint8_t *map = malloc(size);
+  uint8_t *bits = malloc(mask_size);
+  if (map == NULL || bits == NULL || fread(map, 1, size, file) != size ||
+      fread(bits, 1, mask_size, file) != mask_size) {
+    free(map);
+    free(bits);
+    fclose(file);
+    return NULL;
+  }
+  fclose(file);
+
+  // the blob was baked offline: rewrite transparent pixels if LCF uses another key
+  uint32_t key = xpm_transparency_color(XPM_8_8_8);
+  if ((flags & BAKED_TRANSPARENT) && key != baked_key) {
+    for (int i = 0; i < height; i++) {
+      for (int j = 0; j < width; j++) {
+        if (!(bits[i * ((width + 7) / 8) + j / 8] & BIT(j % 8))) {
+          uint8_t *pixel = map + ((size_t) i * width + j) * 3;
+          pixel[0] = key & 0xFF;
+          pixel[1] = (key >> 8) & 0xFF;
+          pixel[2] = (key >> 16) & 0xFF;
+        }
+      }
+    }
+  }
+
+  if (mask != NULL)
+    *mask = bits;
+  else
+    free(bits);
+
+  img->type = XPM_8_8_8;
+  img->width = width;
+  img->height = height;
+  img->size = size;
+  img->bytes = map;
+  return map;
+}
+
+/**
+ * @brief Loads a pixmap
+ *
+ * This function prefers the baked blob of the asset and only parses the XPM
+ * when no blob was built for it (e.g. tools/ was not run).
+ *
+ * @param xpm The XPM of the asset
+ * @param name The name of the asset (the XPM file name without extension)
+ * @param img The image information to fill
+ * @return The pixmap in XPM_8_8_8, or NULL on failure
+ */
+
+uint8_t *load_pixmap(xpm_map_t xpm, const char *name, xpm_image_t *img) {
+  uint8_t *map = load_baked_pixmap(name, img, NULL);
+  if (map == NULL)
+    map = xpm_load(xpm, XPM_8_8_8, img);
+  return map;
+}
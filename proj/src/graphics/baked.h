@@ -0,0 +1,46 @@
+#ifndef _BAKED_H_
+#define _BAKED_H_
+
+#include <lcom/lcf.h>
+#include <stdint.h>
+
+/** @defgroup baked Baked pixmaps
+ * @{
+ *
+ * Pixmaps decoded at build time by tools/xpm_bake, so loading an asset is a
+ * single file read instead of an XPM parse.
+ *
+ * Blob layout (little endian):
+ *  - 0: magic "BBPX"
+ *  - 4: uint16 version
+ *  - 6: uint16 width, 8: uint16 height
+ *  - 10: uint16 flags (bit 0 set if some pixel is transparent)
+ *  - 12: uint32 colour written in transparent pixels
+ *  - 16: width * height pixels, in the layout of xpm_load(XPM_8_8_8)
+ *  - then the transparency mask, one bit per pixel (set if opaque),
+ *    each row padded to a whole byte
+ */
+
+#ifndef BAKED_ASSETS_DIR
+#  define BAKED_ASSETS_DIR "/home/lcom/labs/proj/assets/baked"
+#endif
+
+#define BAKED_MAGIC "BBPX"
+#define BAKED_VERSION 1
+#define BAKED_HEADER_SIZE 16
+#define BAKED_TRANSPARENT BIT(0)
+
+/** Loads the baked blob of the asset "name", filling img like xpm_load().
+ *  If mask is not NULL it receives the transparency mask (free it after use).
+ *  Returns NULL if the blob is missing or invalid.
+ */
+uint8_t *load_baked_pixmap(const char *name, xpm_image_t *img, uint8_t **mask);
+
+/** Loads a pixmap in XPM_8_8_8, from its baked blob if there is one,
+ *  otherwise by parsing the XPM.
+ */
+uint8_t *load_pixmap(xpm_map_t xpm, const char *name, xpm_image_t *img);
+
+/** @} end of baked */
+
+#endif
@@ -0,0 +1,178 @@
+/**
+ * @file blit.c
+ * @brief Portable row kernels and the choice of the kernels to run
+ */
+
+#include "blit.h"
+#include <cpuid.h>
+
+/** @brief Every set of kernels, from the narrowest to the widest */
+static const BlitKernels kernel_sets[] = {
+  {"portable", blit_copy_portable, blit_fill_portable, blit_copy_keyed_portable, blit_copy_portable,
+   blit_stream_fence_portable},
+  // 16 byte streaming stores already fill the write-combining buffers, AVX2 streams as SSE2
+#ifdef VG_RGB565
+  // the SIMD keyed copy writes 24 bit pixels, 5:6:5 ones are packed one by one
+  {"sse2", blit_copy_sse2, blit_fill_sse2, blit_copy_keyed_portable, blit_stream_sse2, blit_stream_fence_sse2},
+  {"avx2", blit_copy_avx2, blit_fill_avx2, blit_copy_keyed_portable, blit_stream_sse2, blit_stream_fence_sse2},
+#else
+  {"sse2", blit_copy_sse2, blit_fill_sse2, blit_copy_keyed_sse2, blit_stream_sse2, blit_stream_fence_sse2},
+  {"avx2", blit_copy_avx2, blit_fill_avx2, blit_copy_keyed_sse2, blit_stream_sse2, blit_stream_fence_sse2},
+#endif
+};
+
+#define NUM_KERNEL_SETS (sizeof(kernel_sets) / sizeof(kernel_sets[0]))
+
+static const BlitKernels *kernels = &kernel_sets[0]; /**< Kernels picked by blit_init() */
+
+/**
+ * @brief Tells whether the processor runs SSE2
+ */
+
+static bool cpu_has_sse2() {
+  unsigned eax, ebx, ecx, edx;
+  return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & BIT(26));
+}
+
+/**
+ * @brief Tells whether the processor runs AVX2 and the system saves its registers
+ *
+ * Besides the AVX2 flag, the system must have enabled XSAVE (OSXSAVE) and the
+ * saving of the 256 bit registers (XCR0 bits 1 and 2), which MINIX does not.
+ */
+
+static bool cpu_has_avx2() {
+  unsigned eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0, NULL) < 7 || !__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return false;
+  if (!(ecx & BIT(27)) || !(ecx & BIT(28))) // OSXSAVE and AVX
+    return false;
+  uint32_t xcr0_low, xcr0_high;
+  __asm__ volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+  if ((xcr0_low & 0x6) != 0x6)
+    return false;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  return ebx & BIT(5);
+}
+
+/**
+ * @brief Tells whether the processor runs a set of kernels
+ *
+ * @param set The index of the set in kernel_sets
+ */
+
+static bool is_supported(unsigned set) {
+  switch (set) {
+    case 0:
+      return true;
+    case 1:
+      return cpu_has_sse2();
+    case 2:
+      return cpu_has_sse2() && cpu_has_avx2();
+    default:
+      return false;
+  }
+}
+
+/**
+ * @brief Picks the widest kernels the processor supports
+ *
+ * Meant to run once, from vg_init(), before anything is drawn.
+ */
+
+void blit_init() {
+  for (unsigned i = 0; i < NUM_KERNEL_SETS; i++) {
+    if (is_supported(i))
+      kernels = &kernel_sets[i];
+  }
+}
+
+/**
+ * @brief Gets the kernels picked by blit_init()
+ *
+ * @return The kernels to draw with
+ */
+
+const BlitKernels *blit_kernels() {
+  return kernels;
+}
+
+/**
+ * @brief Gets a set of kernels the processor supports, for the benchmarks
+ *
+ * @param i The index of the set among the supported ones
+ * @return The set, or NULL if fewer sets are supported
+ */
+
+const BlitKernels *blit_supported_kernels(int i) {
+  for (unsigned set = 0; set < NUM_KERNEL_SETS; set++) {
+    if (is_supported(set) && i-- == 0)
+      return &kernel_sets[set];
+  }
+  return NULL;
+}
+
+/**
+ * @brief Makes the pattern a row is filled with
+ *
+ * The pattern repeats the pixel BLIT_PATTERN_LEN / VG_PIXEL_BYTES times, so
+ * a fill can store it whole, or 16 or 32 bytes of it at a time.
+ *
+ * @param pattern The pattern, BLIT_PATTERN_LEN bytes
+ * @param color The colour, as 0xRRGGBB
+ */
+
+void blit_make_pattern(uint8_t *pattern, uint32_t color) {
+  for (int i = 0; i < BLIT_PATTERN_LEN; i += VG_PIXEL_BYTES)
+    vg_pack_pixel((char *) pattern + i, color);
+}
+
+/**
+ * @brief Copies a row with memcpy()
+ *
+ * @param dst The destination
+ * @param src The source
+ * @param len The number of bytes
+ */
+
+void blit_copy_portable(char *dst, const char *src, size_t len) {
+  memcpy(dst, src, len);
+}
+
+/**
+ * @brief Fills a row a pattern at a time
+ *
+ * @param dst The first byte of the row
+ * @param pattern The pattern, from blit_make_pattern()
+ * @param len The number of bytes, a whole number of pixels
+ */
+
+void blit_fill_portable(char *dst, const uint8_t *pattern, size_t len) {
+  for (; len >= BLIT_PATTERN_LEN; len -= BLIT_PATTERN_LEN, dst += BLIT_PATTERN_LEN)
+    memcpy(dst, pattern, BLIT_PATTERN_LEN);
+  memcpy(dst, pattern, len);
+}
+
+/**
+ * @brief Copies the pixels of a row that are not of the transparency colour
+ *
+ * @param dst The first pixel of the destination, VG_PIXEL_BYTES per pixel
+ * @param src The first pixel of the source, in XPM_8_8_8
+ * @param width The number of pixels
+ * @param key The transparency colour
+ */
+
+void blit_copy_keyed_portable(char *dst, const uint8_t *src, unsigned width, uint32_t key) {
+  for (; width > 0; width--, src += 3, dst += VG_PIXEL_BYTES) {
+    uint32_t color = src[0] | (src[1] << 8) | (src[2] << 16);
+    if (color != key)
+      vg_pack_pixel(dst, color);
+  }
+}
+
+/**
+ * @brief Does nothing, the portable stream kernel writes with ordinary stores
+ */
+
+void blit_stream_fence_portable() {
+}
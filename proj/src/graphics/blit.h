@@ -0,0 +1,66 @@
+#ifndef _BLIT_H_
+#define _BLIT_H_
+
+#include "video_gr.h"
+#include <lcom/lcf.h>
+#include <stdint.h>
+
+/** @defgroup blit Row kernels
+ * @{
+ *
+ * The loops the drawing functions end in: copying a row, filling a row with a
+ * colour and copying the opaque pixels of a pixmap row, plus the copy of
+ * rows to video memory. Each comes in a portable version and in SSE2 and
+ * AVX2 versions. blit_init() picks the widest one the processor runs.
+ */
+
+#define BLIT_PATTERN_LEN 96 ///< bytes of a fill pattern: whole pixels, whole 16 and 32 byte registers
+
+/** A set of row kernels for one instruction set */
+typedef struct {
+  const char *name;
+  /** Copies len bytes, the source and destination must not overlap */
+  void (*copy)(char *dst, const char *src, size_t len);
+  /** Fills len bytes, a whole number of pixels, with a pattern made by blit_make_pattern() */
+  void (*fill)(char *dst, const uint8_t *pattern, size_t len);
+  /** Copies width XPM_8_8_8 pixels to VG_PIXEL_BYTES pixels, skipping those of colour key */
+  void (*copy_keyed)(char *dst, const uint8_t *src, unsigned width, uint32_t key);
+  /** Copies len bytes to video memory, in whole lines written in order and never read */
+  void (*stream)(char *dst, const char *src, size_t len);
+  /** Waits for the rows streamed so far to reach video memory, before the page is shown */
+  void (*stream_fence)();
+} BlitKernels;
+
+/** Picks the widest kernels the processor supports
+ */
+void blit_init();
+
+/** The kernels picked by blit_init(), the portable ones before it is called
+ */
+const BlitKernels *blit_kernels();
+
+/** The i-th set of kernels the processor supports, portable first, NULL past the last
+ */
+const BlitKernels *blit_supported_kernels(int i);
+
+/** Fills a pattern of BLIT_PATTERN_LEN bytes with a colour, as vg_pack_pixel() writes it
+ */
+void blit_make_pattern(uint8_t *pattern, uint32_t color);
+
+void blit_copy_portable(char *dst, const char *src, size_t len);
+void blit_fill_portable(char *dst, const uint8_t *pattern, size_t len);
+void blit_copy_keyed_portable(char *dst, const uint8_t *src, unsigned width, uint32_t key);
+void blit_stream_fence_portable();
+
+void blit_copy_sse2(char *dst, const char *src, size_t len);
+void blit_fill_sse2(char *dst, const uint8_t *pattern, size_t len);
+void blit_copy_keyed_sse2(char *dst, const uint8_t *src, unsigned width, uint32_t key);
+void blit_stream_sse2(char *dst, const char *src, size_t len);
+void blit_stream_fence_sse2();
+
+void blit_copy_avx2(char *dst, const char *src, size_t len);
+void blit_fill_avx2(char *dst, const uint8_t *pattern, size_t len);
+
+/** @} end of blit */
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file blit_avx2.c
+ * @brief Row kernels in AVX2, built with -mavx2 and only run if blit_init() picked them
+ */
+
+#include "blit.h"
+#include <immintrin.h>
+
+/**
+ * @brief Copies a row 128 bytes at a time
+ *
+ * The end of the row is copied 32 bytes at a time, the last 32 bytes of the
+ * row being copied again if the length is not a multiple of 32. Rows shorter
+ * than 32 bytes are left to SSE2.
+ *
+ * @param dst The destination
+ * @param src The source
+ * @param len The number of bytes
+ */
+
+void blit_copy_avx2(char *dst, const char *src, size_t len) {
+  if (len < 32) {
+    blit_copy_sse2(dst, src, len);
+    return;
+  }
+  __m256i last = _mm256_loadu_si256((const __m256i *) (src + len - 32));
+  char *last_dst = dst + len - 32;
+  for (; len >= 128; len -= 128, src += 128, dst += 128) {
+    __m256i a = _mm256_loadu_si256((const __m256i *) src);
+    __m256i b = _mm256_loadu_si256((const __m256i *) (src + 32));
+    __m256i c = _mm256_loadu_si256((const __m256i *) (src + 64));
+    __m256i d = _mm256_loadu_si256((const __m256i *) (src + 96));
+    _mm256_storeu_si256((__m256i *) dst, a);
+    _mm256_storeu_si256((__m256i *) (dst + 32), b);
+    _mm256_storeu_si256((__m256i *) (dst + 64), c);
+    _mm256_storeu_si256((__m256i *) (dst + 96), d);
+  }
+  for (; len >= 32; len -= 32, src += 32, dst += 32)
+    _mm256_storeu_si256((__m256i *) dst, _mm256_loadu_si256((const __m256i *) src));
+  _mm256_storeu_si256((__m256i *) last_dst, last);
+}
+
+/**
+ * @brief Fills a row 96 bytes (32 pixels of 3 bytes, 48 of 2) at a time
+ *
+ * The end of the row, under 96 bytes, is left to SSE2.
+ *
+ * @param dst The first byte of the row
+ * @param pattern The pattern, from blit_make_pattern()
+ * @param len The number of bytes, a whole number of pixels
+ */
+
+void blit_fill_avx2(char *dst, const uint8_t *pattern, size_t len) {
+  __m256i p0 = _mm256_loadu_si256((const __m256i *) pattern);
+  __m256i p1 = _mm256_loadu_si256((const __m256i *) (pattern + 32));
+  __m256i p2 = _mm256_loadu_si256((const __m256i *) (pattern + 64));
+  for (; len >= BLIT_PATTERN_LEN; len -= BLIT_PATTERN_LEN, dst += BLIT_PATTERN_LEN) {
+    _mm256_storeu_si256((__m256i *) dst, p0);
+    _mm256_storeu_si256((__m256i *) (dst + 32), p1);
+    _mm256_storeu_si256((__m256i *) (dst + 64), p2);
+  }
+  blit_fill_sse2(dst, pattern, len);
+}
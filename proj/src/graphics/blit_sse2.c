@@ -0,0 +1,169 @@
+/**
+ * @file blit_sse2.c
+ * @brief Row kernels in SSE2, built with -msse2 and only run if blit_init() picked them
+ */
+
+#include "blit.h"
+#include <emmintrin.h>
+
+#define KEYED_PIXELS 0x249249249249ull /**< Bit 3i set for each of 16 pixels of 3 bytes */
+#define STREAM_MIN_LEN 256             /**< Shorter rows are stored as by blit_copy_sse2() */
+
+/**
+ * @brief Copies a row 64 bytes at a time
+ *
+ * The end of the row is copied 16 bytes at a time, the last 16 bytes of the
+ * row being copied again if the length is not a multiple of 16.
+ *
+ * @param dst The destination
+ * @param src The source
+ * @param len The number of bytes
+ */
+
+void blit_copy_sse2(char *dst, const char *src, size_t len) {
+  if (len < 16) {
+    memcpy(dst, src, len);
+    return;
+  }
+  __m128i last = _mm_loadu_si128((const __m128i *) (src + len - 16));
+  char *last_dst = dst + len - 16;
+  for (; len >= 64; len -= 64, src += 64, dst += 64) {
+    __m128i a = _mm_loadu_si128((const __m128i *) src);
+    __m128i b = _mm_loadu_si128((const __m128i *) (src + 16));
+    __m128i c = _mm_loadu_si128((const __m128i *) (src + 32));
+    __m128i d = _mm_loadu_si128((const __m128i *) (src + 48));
+    _mm_storeu_si128((__m128i *) dst, a);
+    _mm_storeu_si128((__m128i *) (dst + 16), b);
+    _mm_storeu_si128((__m128i *) (dst + 32), c);
+    _mm_storeu_si128((__m128i *) (dst + 48), d);
+  }
+  for (; len >= 16; len -= 16, src += 16, dst += 16)
+    _mm_storeu_si128((__m128i *) dst, _mm_loadu_si128((const __m128i *) src));
+  _mm_storeu_si128((__m128i *) last_dst, last);
+}
+
+/**
+ * @brief Fills a row 48 bytes (16 pixels of 3 bytes, 24 of 2) at a time
+ *
+ * The end of the row is filled 16 bytes at a time, then the last 16 bytes
+ * of the row are stored again from the matching place of the pattern, which
+ * repeats every 48 bytes.
+ *
+ * @param dst The first byte of the row
+ * @param pattern The pattern, from blit_make_pattern()
+ * @param len The number of bytes, a whole number of pixels
+ */
+
+void blit_fill_sse2(char *dst, const uint8_t *pattern, size_t len) {
+  if (len < 16) {
+    memcpy(dst, pattern, len);
+    return;
+  }
+  __m128i p0 = _mm_loadu_si128((const __m128i *) pattern);
+  __m128i p1 = _mm_loadu_si128((const __m128i *) (pattern + 16));
+  __m128i p2 = _mm_loadu_si128((const __m128i *) (pattern + 32));
+  __m128i last = _mm_loadu_si128((const __m128i *) (pattern + (len + 32) % 48));
+  char *last_dst = dst + len - 16;
+  for (; len >= 48; len -= 48, dst += 48) {
+    _mm_storeu_si128((__m128i *) dst, p0);
+    _mm_storeu_si128((__m128i *) (dst + 16), p1);
+    _mm_storeu_si128((__m128i *) (dst + 32), p2);
+  }
+  if (len >= 16)
+    _mm_storeu_si128((__m128i *) dst, p0);
+  if (len >= 32)
+    _mm_storeu_si128((__m128i *) (dst + 16), p1);
+  _mm_storeu_si128((__m128i *) last_dst, last);
+}
+
+/**
+ * @brief Copies the pixels of a 24 bit row that are not of the transparency colour
+ *
+ * Sixteen pixels (48 bytes) are compared with the key at once. A pixel is
+ * transparent if its 3 bytes match, so the 48 byte comparisons are ANDed in
+ * groups of 3. Blocks without transparent pixels are stored whole, blocks
+ * without opaque ones skipped, and the others copied pixel by pixel.
+ *
+ * @param dst The first pixel of the destination
+ * @param src The first pixel of the source, in XPM_8_8_8
+ * @param width The number of pixels
+ * @param key The transparency colour
+ */
+
+void blit_copy_keyed_sse2(char *dst, const uint8_t *src, unsigned width, uint32_t key) {
+  uint8_t key_bytes[48];
+  for (int i = 0; i < 48; i++)
+    key_bytes[i] = (key >> (8 * (i % 3))) & 0xFF;
+  __m128i k0 = _mm_loadu_si128((const __m128i *) key_bytes);
+  __m128i k1 = _mm_loadu_si128((const __m128i *) (key_bytes + 16));
+  __m128i k2 = _mm_loadu_si128((const __m128i *) (key_bytes + 32));
+
+  for (; width >= 16; width -= 16, src += 48, dst += 48) {
+    __m128i a = _mm_loadu_si128((const __m128i *) src);
+    __m128i b = _mm_loadu_si128((const __m128i *) (src + 16));
+    __m128i c = _mm_loadu_si128((const __m128i *) (src + 32));
+    uint64_t equal = (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(a, k0)) |
+                     (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(b, k1)) << 16 |
+                     (uint64_t) _mm_movemask_epi8(_mm_cmpeq_epi8(c, k2)) << 32;
+    uint64_t keyed = equal & (equal >> 1) & (equal >> 2) & KEYED_PIXELS;
+    if (keyed == 0) {
+      _mm_storeu_si128((__m128i *) dst, a);
+      _mm_storeu_si128((__m128i *) (dst + 16), b);
+      _mm_storeu_si128((__m128i *) (dst + 32), c);
+    }
+    else if (keyed != KEYED_PIXELS)
+      blit_copy_keyed_portable(dst, src, 16, key);
+  }
+  blit_copy_keyed_portable(dst, src, width, key);
+}
+
+/**
+ * @brief Copies a row to video memory with stores that bypass the cache
+ *
+ * Rows shorter than STREAM_MIN_LEN, such as those of a sprite, are copied
+ * by blit_copy_sse2(): streaming a few lines, most of them partly, costs
+ * more than it saves. Otherwise the first 16 bytes are stored as they are,
+ * then the destination goes on 16 byte aligned so the rest is written with
+ * streaming stores, 64 bytes (one write-combining line) at a time. The last 16 bytes are stored again as in
+ * blit_copy_sse2(). The streaming stores are not ordered with the others,
+ * blit_stream_fence_sse2() must run before the page is shown.
+ *
+ * @param dst The destination, in video memory
+ * @param src The source, in system memory
+ * @param len The number of bytes
+ */
+
+void blit_stream_sse2(char *dst, const char *src, size_t len) {
+  if (len < STREAM_MIN_LEN) {
+    blit_copy_sse2(dst, src, len);
+    return;
+  }
+  __m128i last = _mm_loadu_si128((const __m128i *) (src + len - 16));
+  char *last_dst = dst + len - 16;
+  _mm_storeu_si128((__m128i *) dst, _mm_loadu_si128((const __m128i *) src));
+  size_t skip = 16 - ((uintptr_t) dst & 15);
+  dst += skip;
+  src += skip;
+  len -= skip;
+  for (; len >= 64; len -= 64, src += 64, dst += 64) {
+    __m128i a = _mm_loadu_si128((const __m128i *) src);
+    __m128i b = _mm_loadu_si128((const __m128i *) (src + 16));
+    __m128i c = _mm_loadu_si128((const __m128i *) (src + 32));
+    __m128i d = _mm_loadu_si128((const __m128i *) (src + 48));
+    _mm_stream_si128((__m128i *) dst, a);
+    _mm_stream_si128((__m128i *) (dst + 16), b);
+    _mm_stream_si128((__m128i *) (dst + 32), c);
+    _mm_stream_si128((__m128i *) (dst + 48), d);
+  }
+  for (; len >= 16; len -= 16, src += 16, dst += 16)
+    _mm_stream_si128((__m128i *) dst, _mm_loadu_si128((const __m128i *) src));
+  _mm_storeu_si128((__m128i *) last_dst, last);
+}
+
+/**
+ * @brief Waits for the streaming stores to leave the write-combining buffers
+ */
+
+void blit_stream_fence_sse2() {
+  _mm_sfence();
+}
@@ -0,0 +1,212 @@
+/**
+ * @file font.c
+ * @brief Implementation file for bitmap fonts
+ */
+
+#include "font.h"
+
+/**
+ * @brief Loads a font
+ *
+ * This function decodes the font strip and compiles the opaque spans of every
+ * glyph, so drawing a character only copies the runs of that glyph.
+ *
+ * @param font The font to fill
+ * @param asset The asset of the font strip
+ * @param num_glyphs The number of glyphs in the strip
+ * @param width The width of a glyph
+ * @param height The height of a glyph
+ * @param offset The gap between two glyphs in the strip
+ * @return 0 on success, 1 otherwise
+ */
+
+int load_font(Font *font, AssetId asset, int num_glyphs,
+              uint16_t width, uint16_t height, uint16_t offset) {
+  xpm_image_t img;
+  font->width = width;
+  font->height = height;
+  font->offset = offset;
+  font->num_glyphs = 0;
+  font->glyphs = NULL;
+  font->map = load_asset(asset, &img);
+  if (font->map == NULL)
+    return 1;
+  font->glyphs = malloc(num_glyphs * sizeof(SpanMap *));
+  if (font->glyphs == NULL) {
+    free_font(font);
+    return 1;
+  }
+
+  if (font->height > img.height)
+    font->height = img.height;
+  for (int i = 0; i < num_glyphs; i++) {
+    int glyph_x = i * (width + offset);
+    if (glyph_x + width > img.width)
+      break;
+    font->glyphs[i] = compile_spans(font->map, img.width, glyph_x, width, font->height);
+    if (font->glyphs[i] == NULL) {
+      free_font(font);
+      return 1;
+    }
+    font->num_glyphs++;
+  }
+  vg_pack_pixmap(font->map, (size_t) img.width * img.height);
+  return 0;
+}
+
+/**
+ * @brief Frees the memory allocated for a font
+ *
+ * @param font The font to free
+ */
+
+void free_font(Font *font) {
+  for (int i = 0; i < font->num_glyphs; i++)
+    free_spans(font->glyphs[i]);
+  free(font->glyphs);
+  free(font->map);
+  font->glyphs = NULL;
+  font->map = NULL;
+  font->num_glyphs = 0;
+}
+
+/**
+ * @brief Finds the glyph of a character
+ *
+ * Letters and digits are both looked up from the start of the strip, so
+ * a letters font draws 'A' to 'Z' and a numbers font '0' to '9'.
+ *
+ * @param c The character
+ * @param font The font
+ * @return The index of the glyph, -1 if the font has none for c
+ */
+
+static int find_glyph(char c, const Font *font) {
+  int char_pos;
+  if (c >= 'A' && c <= 'Z') {
+    char_pos = c - 'A';
+  }
+  else if (c >= '0' && c <= '9') {
+    char_pos = c - '0';
+  }
+  else {
+    return -1;
+  }
+  if (char_pos >= font->num_glyphs)
+    return -1;
+  return char_pos;
+}
+
+/**
+ * @brief Draws a character on the screen.
+ *
+ * The character is clipped to the screen.
+ *
+ * @param c The character to be drawn.
+ * @param x The X coordinate of the character.
+ * @param y The Y coordinate of the character.
+ * @param font The font to draw with.
+ */
+
+void draw_character(char c, int x, int y, const Font *font) {
+  int glyph = find_glyph(c, font);
+  if (glyph < 0)
+    return;
+  draw_spans(font->glyphs[glyph], font->map, get_drawing_buffer(), get_h_res(), get_v_res(), x, y);
+  vg_mark_dirty(x, y, font->width, font->height);
+}
+
+/**
+ * @brief Draws a string on the screen.
+ *
+ * @param str The string to be drawn.
+ * @param x The X coordinate of the string.
+ * @param y The Y coordinate of the string.
+ * @param font The font to draw with.
+ */
+
+void draw_string(const char *str, int x, int y, const Font *font) {
+  int current_x = x;
+  while (*str) {
+    draw_character(*str, current_x, y, font);
+    current_x += font->width + font->offset;
+    str++;
+  }
+}
+
+/**
+ * @brief Draws a string into a buffer other than the drawing buffer.
+ *
+ * Nothing is marked as drawn over. The glyphs are clipped to the screen and
+ * those past its right edge are not looked up.
+ *
+ * @param str The string to be drawn.
+ * @param x The X coordinate of the string.
+ * @param y The Y coordinate of the string.
+ * @param font The font to draw with.
+ * @param buffer A buffer of the size of the screen.
+ */
+
+void draw_string_to_buffer(const char *str, int x, int y, const Font *font, char *buffer) {
+  int advance = font->width + font->offset;
+  for (; *str && x < (int) get_h_res(); str++, x += advance) {
+    int glyph = find_glyph(*str, font);
+    if (glyph >= 0)
+      draw_spans(font->glyphs[glyph], font->map, buffer, get_h_res(), get_v_res(), x, y);
+  }
+}
+
+/**
+ * @brief Prepares a text layer
+ *
+ * Nothing is drawn: the background under the layer is taken as freshly
+ * redrawn, so the next set_layer_text() draws whatever it is given.
+ *
+ * @param layer The layer to prepare
+ * @param font The font of its text
+ * @param x The X coordinate of the text
+ * @param y The Y coordinate of the text
+ * @param background The colour of the background under the text
+ */
+
+void init_text_layer(TextLayer *layer, const Font *font, int x, int y, uint32_t background) {
+  layer->font = font;
+  layer->x = x;
+  layer->y = y;
+  layer->background = background;
+  layer->text[0] = '\0';
+}
+
+/**
+ * @brief Changes the text of a layer
+ *
+ * The text is drawn into the arena background, where the flips keep it on
+ * screen, so this costs a string comparison unless the text changed. Then
+ * the old text is cleared and the new one drawn, and only that area is
+ * copied to the buffers. Text longer than TEXT_LAYER_LEN is cut.
+ *
+ * @param layer The layer
+ * @param text The text to show
+ * @return true if the text changed and was drawn, false otherwise
+ */
+
+bool set_layer_text(TextLayer *layer, const char *text) {
+  if (strncmp(layer->text, text, TEXT_LAYER_LEN) == 0)
+    return false;
+
+  const Font *font = layer->font;
+  int advance = font->width + font->offset;
+  int width = strlen(layer->text) * advance;
+  strncpy(layer->text, text, TEXT_LAYER_LEN);
+  layer->text[TEXT_LAYER_LEN] = '\0';
+  if ((int) strlen(layer->text) * advance > width)
+    width = strlen(layer->text) * advance;
+  if (layer->x + width > (int) get_h_res())
+    width = get_h_res() - layer->x;
+
+  char *buffer = get_arena_buffer();
+  vg_fill_rect_to_buffer(buffer, layer->x, layer->y, width, font->height, layer->background);
+  draw_string_to_buffer(layer->text, layer->x, layer->y, font, buffer);
+  vg_background_updated(layer->x, layer->y, width, font->height);
+  return true;
+}
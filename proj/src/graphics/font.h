@@ -0,0 +1,69 @@
+#ifndef _FONT_H_
+#define _FONT_H_
+
+#include <lcom/lcf.h>
+#include "video_gr.h"
+#include "assets.h"
+#include "spans.h"
+
+/** @defgroup font Font
+ * @{
+ *
+ * Bitmap fonts: a strip of equally sized glyphs, either 'A' to 'Z' or '0' to '9'.
+ */
+
+/** A font strip with the opaque spans of each glyph */
+typedef struct {
+  uint8_t *map;           ///< the decoded strip
+  uint16_t width, height; ///< dimensions of a glyph
+  uint16_t offset;        ///< gap between two glyphs in the strip
+  int num_glyphs;         ///< number of glyphs in the strip
+  SpanMap **glyphs;       ///< opaque spans of each glyph
+} Font;
+
+#define TEXT_LAYER_LEN 15 ///< longest text of a text layer
+
+/** A string kept in the arena background, redrawn only when it changes */
+typedef struct {
+  const Font *font;
+  int x, y;                        ///< where the text starts
+  uint32_t background;             ///< colour under the text
+  char text[TEXT_LAYER_LEN + 1];   ///< the text in the background, "" if none
+} TextLayer;
+
+/** Loads the strip of num_glyphs glyphs, width x height each and offset
+ *  pixels apart, and compiles the spans of each glyph.
+ *  Returns 0 on success, 1 otherwise.
+ */
+int load_font(Font *font, AssetId asset, int num_glyphs,
+              uint16_t width, uint16_t height, uint16_t offset);
+
+/** Releases the strip and the spans of a font
+ */
+void free_font(Font *font);
+
+/** Draws a character, anything outside the font is skipped
+ */
+void draw_character(char c, int x, int y, const Font *font);
+
+/** Draws a string, one glyph after the other
+ */
+void draw_string(const char *str, int x, int y, const Font *font);
+
+/** Draws a string into another buffer than the drawing buffer, such as a
+ *  background, without marking it as drawn over
+ */
+void draw_string_to_buffer(const char *str, int x, int y, const Font *font, char *buffer);
+
+/** Prepares a text layer over a freshly drawn background, showing nothing
+ */
+void init_text_layer(TextLayer *layer, const Font *font, int x, int y, uint32_t background);
+
+/** Draws text into the arena background if it differs from the layer's,
+ *  returns true if it did
+ */
+bool set_layer_text(TextLayer *layer, const char *text);
+
+/** @} end of font */
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * @file spans.c
+ * @brief Implementation file for compiling and drawing opaque spans
+ */
+
+#include "spans.h"
+#include <sys/param.h>
+
+/**
+ * @brief Tells whether a pixel of an XPM_8_8_8 pixmap is opaque
+ *
+ * @param pixel The pixel
+ * @param key The transparency colour
+ * @return true if the pixel is opaque
+ */
+
+static bool is_opaque(const uint8_t *pixel, uint32_t key) {
+  return (uint32_t) (pixel[0] | (pixel[1] << 8) | (pixel[2] << 16)) != key;
+}
+
+/**
+ * @brief Compiles an area of a pixmap into opaque spans
+ *
+ * This function is meant to run once, when the pixmap is loaded. The area is
+ * scanned twice: first to count the spans, then to fill them, so the whole
+ * result lives in a single allocation.
+ *
+ * @param map The pixmap, in XPM_8_8_8
+ * @param pitch The width of the pixmap, in pixels
+ * @param x The first column of the area
+ * @param width The width of the area
+ * @param height The height of the area
+ * @return The compiled spans, or NULL if memory allocation fails
+ */
+
+SpanMap *compile_spans(const uint8_t *map, uint16_t pitch, uint16_t x, uint16_t width, uint16_t height) {
+  uint32_t key = xpm_transparency_color(XPM_8_8_8);
+  uint32_t num_spans = 0;
+
+  for (int i = 0; i < height; i++) {
+    const uint8_t *row = map + ((size_t) i * pitch + x) * 3;
+    bool in_span = false;
+    for (int j = 0; j < width; j++) {
+      bool opaque = is_opaque(row + j * 3, key);
+      if (opaque && !in_span)
+        num_spans++;
+      in_span = opaque;
+    }
+  }
+
+  SpanMap *spans = malloc(sizeof(SpanMap) + (height + 1) * sizeof(uint32_t) + num_spans * sizeof(Span));
+  if (spans == NULL)
+    return NULL;
+  spans->width = width;
+  spans->height = height;
+  spans->rows = (uint32_t *) (spans + 1);
+  spans->spans = (Span *) (spans->rows + height + 1);
+
+  Span *span = spans->spans;
+  for (int i = 0; i < height; i++) {
+    spans->rows[i] = span - spans->spans;
+    const uint8_t *row = map + ((size_t) i * pitch + x) * 3;
+    int j = 0;
+    while (j < width) {
+      if (!is_opaque(row + j * 3, key)) {
+        j++;
+        continue;
+      }
+      int start = j;
+      while (j < width && is_opaque(row + j * 3, key))
+        j++;
+      span->x = start;
+      span->len = j - start;
+      span->src = (size_t) i * pitch + x + start;
+      span++;
+    }
+  }
+  spans->rows[height] = num_spans;
+  return spans;
+}
+
+/**
+ * @brief Frees compiled spans
+ *
+ * @param spans The spans to free
+ */
+
+void free_spans(SpanMap *spans) {
+  free(spans);
+}
+
+/**
+ * @brief Draws a pixmap through its compiled spans
+ *
+ * Each opaque run is copied with a single memcpy(), transparent pixels are
+ * never read. An area inside the buffer is drawn without any bounds check.
+ * Otherwise the rows and columns in the buffer are worked out once, the rows
+ * outside are skipped and each run is cut to those columns, so the area can
+ * lie partly or wholly off the buffer.
+ *
+ * @param spans The spans compiled from the pixmap
+ * @param map The pixmap, converted by vg_pack_pixmap()
+ * @param buffer The buffer to draw into, VG_PIXEL_BYTES per pixel
+ * @param width The width of the buffer, in pixels
+ * @param height The height of the buffer, in pixels
+ * @param x The x position of the area's top left corner
+ * @param y The y position of the area's top left corner
+ */
+
+void draw_spans(const SpanMap *spans, const uint8_t *map, char *buffer, unsigned width, unsigned height, int x, int y) {
+  if (x >= 0 && y >= 0 && x + spans->width <= (int) width && y + spans->height <= (int) height) {
+    const Span *span = spans->spans;
+    for (int i = 0; i < spans->height; i++) {
+      char *row = buffer + ((size_t) (y + i) * width + x) * VG_PIXEL_BYTES;
+      const Span *end = spans->spans + spans->rows[i + 1];
+      for (; span < end; span++)
+        memcpy(row + span->x * VG_PIXEL_BYTES, map + span->src * VG_PIXEL_BYTES, span->len * VG_PIXEL_BYTES);
+    }
+    return;
+  }
+
+  // the rows and columns of the area that lie in the buffer
+  int first_row = MAX(0, -y), last_row = MIN((int) spans->height, (int) height - y);
+  int left = MAX(0, -x), right = MIN((int) spans->width, (int) width - x);
+  if (first_row >= last_row || left >= right)
+    return;
+  for (int i = first_row; i < last_row; i++) {
+    char *row = buffer + (size_t) (y + i) * width * VG_PIXEL_BYTES;
+    const Span *end = spans->spans + spans->rows[i + 1];
+    for (const Span *span = spans->spans + spans->rows[i]; span < end; span++) {
+      int start = MAX((int) span->x, left), stop = MIN(span->x + span->len, right);
+      if (start < stop)
+        memcpy(row + (x + start) * VG_PIXEL_BYTES, map + (span->src + start - span->x) * VG_PIXEL_BYTES,
+               (stop - start) * VG_PIXEL_BYTES);
+    }
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef _SPANS_H_
+#define _SPANS_H_
+
+#include "video_gr.h"
+#include <lcom/lcf.h>
+#include <stdint.h>
+
+/** @defgroup spans Opaque spans
+ * @{
+ *
+ * A pixmap compiled into the runs of opaque pixels of each row, so drawing
+ * it is a sequence of memcpy() calls instead of a transparency test per pixel.
+ */
+
+/** A run of opaque pixels in a row */
+typedef struct {
+  uint16_t x;    ///< first pixel of the run, relative to the compiled area
+  uint16_t len;  ///< number of pixels in the run
+  uint32_t src;  ///< index of the run's first pixel in the pixmap
+} Span;
+
+/** The spans of every row of a rectangular area of a pixmap */
+typedef struct {
+  uint16_t width, height; ///< dimensions of the compiled area
+  uint32_t *rows;         ///< spans of row i are spans[rows[i]] up to spans[rows[i + 1]]
+  Span *spans;            ///< every span, row by row
+} SpanMap;
+
+/** Compiles the width x height area starting at column x of an XPM_8_8_8
+ *  pixmap "pitch" pixels wide. Returns NULL if memory allocation fails.
+ */
+SpanMap *compile_spans(const uint8_t *map, uint16_t pitch, uint16_t x, uint16_t width, uint16_t height);
+
+/** Releases compiled spans
+ */
+void free_spans(SpanMap *spans);
+
+/** Draws the opaque pixels of "map", converted by vg_pack_pixmap(), at (x, y)
+ *  of a buffer of width x height pixels, clipped to it
+ */
+void draw_spans(const SpanMap *spans, const uint8_t *map, char *buffer, unsigned width, unsigned height, int x, int y);
+
+/** @} end of spans */
+
+#endif
@@ -9,9 +9,10 @@
  * @brief Creates a sprite
  *
  * This function allocates memory for a sprite object and initializes it
- * with the provided pixmap, position, and speed.
+ * with the provided pixmap, position, and speed. The opaque spans of the
+ * pixmap are compiled here, once, so drawing never tests for transparency.
  *
- * @param pic The pixmap for the sprite
+ * @param asset The asset of the pixmap for the sprite
  * @param x The initial x position of the sprite
  * @param y The initial y position of the sprite
  * @param xspeed The initial x speed of the sprite
@@ -19,7 +20,7 @@
  * @return A pointer to the created sprite, or NULL if creation fails
  */
 
-Sprite *create_sprite(const char *pic[], int x, int y,
+Sprite *create_sprite(AssetId asset, int x, int y,
                       int xspeed, int yspeed) {
   // allocate space for the "object"
   Sprite *sp = (Sprite *) malloc(sizeof(Sprite));
@@ -27,11 +28,18 @@ Sprite *create_sprite(const char *pic[], int x, int y,
   if (sp == NULL)
     return NULL;
   // read the sprite pixmap
-  sp->map = xpm_load(pic, XPM_8_8_8, &img);
+  sp->map = load_asset(asset, &img);
   if (sp->map == NULL) {
     free(sp);
     return NULL;
   }
+  sp->spans = compile_spans(sp->map, img.width, 0, img.width, img.height);
+  if (sp->spans == NULL) {
+    free(sp->map);
+    free(sp);
+    return NULL;
+  }
+  vg_pack_pixmap(sp->map, (size_t) img.width * img.height);
   sp->width = img.width;
   sp->height = img.height;
   sp->x = x;
@@ -44,8 +52,8 @@ Sprite *create_sprite(const char *pic[], int x, int y,
 /**
  * @brief Destroys a sprite
  *
- * This function frees the memory allocated for a sprite, including its pixmap
- * and the sprite structure itself.
+ * This function frees the memory allocated for a sprite, including its pixmap,
+ * its spans and the sprite structure itself.
  *
  * @param sp The sprite to destroy
  */
@@ -55,6 +63,7 @@ void destroy_sprite(Sprite *sp) {
     return;
   if (sp->map)
     free(sp->map);
+  free_spans(sp->spans);
   free(sp);
   sp = NULL; // XXX: pointer is passed by value
   // should do this @ the caller
@@ -83,44 +92,42 @@ int animate_sprite(Sprite *sp) {
 /**
  * @brief Draws a sprite
  *
- * This function draws the sprite on the screen by copying its pixmap to
- * the drawing buffer.
+ * This function draws the sprite on the screen by copying the opaque runs of
+ * its pixmap to the drawing buffer, and marks its area to be restored. The
+ * sprite may lie partly or wholly off the screen, it is clipped.
  *
  * @param sp The sprite to draw
  * @return Always returns 0
  */
 
-/* Some useful non-visible functions */
 int draw_sprite(Sprite *sp) {
-  char* buffer = get_drawing_buffer();
-  unsigned h_res = get_h_res();
-  uint32_t color;
-  uint32_t desl;
-  int color_index;
-  int x = sp->x;
-  int y = sp->y;
-  uint16_t height = sp->height;
-  uint16_t width = sp->width;
-  unsigned char* map_ptr = sp->map;
-  for (int i = 0; i < height; i++) {
-    for (int j = 0; j < width; j++) {
-      desl = (i * width + j) * 3;
-      color = map_ptr[desl] | (map_ptr[desl + 1] << 8) | (map_ptr[desl + 2] << 16);
-      if(color != xpm_transparency_color(XPM_8_8_8)){
-        color_index = (h_res * (y + i) + (x + j)) * 3;
-        buffer[color_index] = color & 0xFF;
-        buffer[color_index + 1] = (color >> 8) & 0xFF;
-        buffer[color_index + 2] = (color >> 16) & 0xFF;
-      }
-    }
-  }
+  return draw_sprite_at(sp, sp->x, sp->y);
+}
+
+/**
+ * @brief Draws a sprite at another position
+ *
+ * Meant for a sprite whose pixmap is shared by many objects, each keeping
+ * its own position.
+ *
+ * @param sp The sprite to draw
+ * @param x The x position to draw it at
+ * @param y The y position to draw it at
+ * @return Always returns 0
+ */
+
+int draw_sprite_at(Sprite *sp, int x, int y) {
+  draw_spans(sp->spans, sp->map, get_drawing_buffer(), get_h_res(), get_v_res(), x, y);
+  vg_mark_dirty(x, y, sp->width, sp->height);
   return 0;
 }
 
 /**
  * @brief Draws a sprite to a specified buffer
  *
- * This function draws the sprite by copying its pixmap to the specified buffer.
+ * This function draws the sprite by copying the opaque runs of its pixmap to
+ * the specified buffer, which must have the dimensions of the screen. The
+ * sprite is clipped to it.
  *
  * @param sp The sprite to draw
  * @param buffer The buffer to draw the sprite onto
@@ -128,26 +135,6 @@ int draw_sprite(Sprite *sp) {
  */
 
 int draw_sprite_to_buffer(Sprite *sp, char* buffer) {
-  uint32_t color;
-  uint32_t desl;
-  int color_index;
-  int x = sp->x;
-  int y = sp->y;
-  uint16_t height = sp->height;
-  uint16_t width = sp->width;
-  unsigned char* map_ptr = sp->map;
-  for (int i = 0; i < height; i++) {
-    for (int j = 0; j < width; j++) {
-      desl = (i * width + j) * 3;
-      color = map_ptr[desl] | (map_ptr[desl + 1] << 8) | (map_ptr[desl + 2] << 16);
-      if(color != xpm_transparency_color(XPM_8_8_8)){
-        color_index = (width * (y + i) + (x + j)) * 3;
-        buffer[color_index] = color & 0xFF;
-        buffer[color_index + 1] = (color >> 8) & 0xFF;
-        buffer[color_index + 2] = (color >> 16) & 0xFF;
-      }
-    }
-  }
+  draw_spans(sp->spans, sp->map, buffer, get_h_res(), get_v_res(), sp->x, sp->y);
   return 0;
 }
-
@@ -8,6 +8,8 @@
 
 #include <lcom/lcf.h>
 #include "video_gr.h"
+#include "assets.h"
+#include "spans.h"
 #include "../view/constants.h"
 
 /** @defgroup sprite Sprite
@@ -22,18 +24,19 @@
  * other graphical objects or the screen limits. 
  */
 typedef struct {
-  uint16_t x,y;             /**< current sprite position */
+  int16_t x,y;              /**< current sprite position, may lie past the screen edges */
   uint16_t width, height;   /**< sprite dimensions */
   int xspeed, yspeed;  /**< current speeds in the x and y direction */
   unsigned char *map;           /**< the sprite pixmap (use read_xpm()) */
+  SpanMap *spans;           /**< opaque spans of the pixmap, drawn instead of testing each pixel */
 } Sprite;
 
 /** Creates with random speeds (not zero) and position
- * (within the screen limits), a new sprite with pixmap "pic", in
+ * (within the screen limits), a new sprite with the pixmap of "asset", in
  * memory whose address is "base";
  * Returns NULL on invalid pixmap.
  */
-Sprite *create_sprite(const char *pic[], int x, int y,
+Sprite *create_sprite(AssetId asset, int x, int y,
                       int xspeed, int yspeed);
 
 /** Animate the sprite "fig" according to its attributes in memory,
@@ -52,6 +55,7 @@ Sprite *create_sprite(const char *pic[], int x, int y,
 int animate_sprite(Sprite *sp);
 
 int draw_sprite(Sprite *sp);
+int draw_sprite_at(Sprite *sp, int x, int y);
 int draw_sprite_to_buffer(Sprite *sp, char* buffer);
 
 /** The "fig" sprite is erased from memory whose address is "base"
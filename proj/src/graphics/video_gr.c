@@ -4,11 +4,15 @@
  */
 
 #include "video_gr.h"
+#include "blit.h"
 
 static char *video_mem;            /**< Process (virtual) address to which VRAM is mapped */
-static char *first_buffer;         /**< First double buffer */
-static char *second_buffer;        /**< Second double buffer */
+static char *vram_pages[2];        /**< VRAM pages showing the first and the second buffer */
+static char *first_buffer;         /**< First double buffer, in system memory */
+static char *second_buffer;        /**< Second double buffer, in system memory */
 static char *arena_buffer;         /**< Buffer for arena drawing */
+static char *menu_buffer;          /**< Buffer for the static layer of a menu */
+static char *background_buffer;    /**< Buffer the double buffers are restored from */
 static char *drawing_buffer;       /**< Current buffer used for drawing */
 bool drawing_first_buffer = false; /**< Flag to track the current drawing buffer */
 
@@ -17,6 +21,164 @@ static unsigned v_res;           /**< Vertical resolution in pixels */
 static unsigned bits_per_pixel;  /**< Number of VRAM bits per pixel */
 static unsigned bytes_per_pixel; /**< Number of bytes per pixel */
 
+/** @brief Regions of a double buffer drawn over the background */
+typedef struct {
+  uint16_t x[MAX_DIRTY_RECTS], y[MAX_DIRTY_RECTS];
+  uint16_t width[MAX_DIRTY_RECTS], height[MAX_DIRTY_RECTS];
+  int num_rects;
+  bool full; /**< Too many regions, or the background changed: restore everything */
+} DirtyRects;
+
+static DirtyRects first_dirty = {.full = true};  /**< What was drawn on the first buffer */
+static DirtyRects second_dirty = {.full = true}; /**< What was drawn on the second buffer */
+static DirtyRects stale = {.full = true};        /**< Regions of the drawing buffer not uploaded to its page yet */
+static unsigned restored_bytes;                  /**< Bytes restored by the last flip */
+static unsigned uploaded_bytes;                  /**< Bytes written to VRAM by the last flip */
+
+/**
+ * @brief Clips a rectangle to the screen
+ *
+ * @param x The x-coordinate of the rectangle, updated
+ * @param y The y-coordinate of the rectangle, updated
+ * @param width The width of the rectangle, updated
+ * @param height The height of the rectangle, updated
+ * @return true if some of the rectangle is on the screen
+ */
+
+static bool clip_rect(int *x, int *y, int *width, int *height) {
+  if (*x < 0) {
+    *width += *x;
+    *x = 0;
+  }
+  if (*y < 0) {
+    *height += *y;
+    *y = 0;
+  }
+  if (*x + *width > (int) h_res)
+    *width = h_res - *x;
+  if (*y + *height > (int) v_res)
+    *height = v_res - *y;
+  return *width > 0 && *height > 0;
+}
+
+#ifdef VG_RGB565
+static uint32_t expand_low[256];  /**< 24 bit colour bits held by the low byte of a pixel */
+static uint32_t expand_high[256]; /**< 24 bit colour bits held by the high byte of a pixel */
+
+/**
+ * @brief Fills the tables expanding 5:6:5 pixels to 24 bit
+ *
+ * The low byte of a pixel is GGGBBBBB and the high byte RRRRRGGG. Each field
+ * is widened by repeating its top bits, so white stays white. The bits given
+ * by each byte do not overlap, a pixel is the OR of its two entries.
+ */
+
+static void init_expansion() {
+  for (unsigned byte = 0; byte < 256; byte++) {
+    unsigned blue = byte & 0x1F, green_low = byte >> 5;
+    unsigned red = byte >> 3, green_high = byte & 0x07;
+    expand_low[byte] = ((blue << 3) | (blue >> 2)) | (green_low << 10);
+    expand_high[byte] = (((red << 3) | (red >> 2)) << 16) | (green_high << 13) | ((green_high >> 1) << 8);
+  }
+}
+
+/**
+ * @brief Expands a row of 5:6:5 pixels to 24 bit
+ *
+ * Four pixels (8 bytes) become three 32 bit words (12 bytes), written at
+ * once. The last width % 4 pixels are written byte by byte.
+ *
+ * @param dst The first 24 bit pixel
+ * @param src The first 5:6:5 pixel
+ * @param width The number of pixels
+ */
+
+static void expand_row(char *dst, const uint8_t *src, unsigned width) {
+  for (; width >= 4; width -= 4, src += 8, dst += 12) {
+    uint32_t p0 = expand_low[src[0]] | expand_high[src[1]];
+    uint32_t p1 = expand_low[src[2]] | expand_high[src[3]];
+    uint32_t p2 = expand_low[src[4]] | expand_high[src[5]];
+    uint32_t p3 = expand_low[src[6]] | expand_high[src[7]];
+    uint32_t words[3] = {p0 | (p1 << 24), (p1 >> 8) | (p2 << 16), (p2 >> 16) | (p3 << 8)};
+    memcpy(dst, words, sizeof(words));
+  }
+  for (; width > 0; width--, src += 2, dst += 3) {
+    uint32_t pixel = expand_low[src[0]] | expand_high[src[1]];
+    dst[0] = pixel & 0xFF;
+    dst[1] = (pixel >> 8) & 0xFF;
+    dst[2] = (pixel >> 16) & 0xFF;
+  }
+}
+#endif
+
+/**
+ * @brief Uploads a region of the drawing buffer to its VRAM page
+ *
+ * The rows are written in order and VRAM is never read. With VG_RGB565 they
+ * are expanded to 24 bit, otherwise streamed by the stream kernel, at once
+ * if the region spans whole rows.
+ *
+ * @param page The VRAM page of the drawing buffer
+ * @param x The x-coordinate of the region, on the screen
+ * @param y The y-coordinate of the region
+ * @param width The width of the region
+ * @param height The height of the region
+ */
+
+static void upload_rect(char *page, int x, int y, int width, int height) {
+  unsigned pitch = h_res * VG_PIXEL_BYTES, page_pitch = h_res * bytes_per_pixel;
+  const char *src = drawing_buffer + y * pitch + x * VG_PIXEL_BYTES;
+  char *dst = page + y * page_pitch + x * bytes_per_pixel;
+#ifdef VG_RGB565
+  for (int row = 0; row < height; row++, src += pitch, dst += page_pitch)
+    expand_row(dst, (const uint8_t *) src, width);
+#else
+  const BlitKernels *blit = blit_kernels();
+  if (width == (int) h_res)
+    blit->stream(dst, src, pitch * height);
+  else {
+    for (int row = 0; row < height; row++, src += pitch, dst += page_pitch)
+      blit->stream(dst, src, width * VG_PIXEL_BYTES);
+  }
+#endif
+  uploaded_bytes += width * height * bytes_per_pixel;
+}
+
+/**
+ * @brief Uploads some regions of the drawing buffer to its VRAM page
+ *
+ * @param rects The regions
+ * @param page The VRAM page of the drawing buffer
+ */
+
+static void upload_rects(const DirtyRects *rects, char *page) {
+  for (int i = 0; i < rects->num_rects; i++)
+    upload_rect(page, rects->x[i], rects->y[i], rects->width[i], rects->height[i]);
+}
+
+/**
+ * @brief Brings the VRAM page of the drawing buffer up to date
+ *
+ * The page last showed this buffer two frames ago. Since then the regions
+ * restored by the last flip, those the background was updated in and those
+ * drawn in this frame changed, so only those are uploaded.
+ */
+
+static void present_drawing_buffer() {
+  DirtyRects *dirty = drawing_first_buffer ? &first_dirty : &second_dirty;
+  char *page = vram_pages[drawing_first_buffer ? 0 : 1];
+  uploaded_bytes = 0;
+  if (stale.full || dirty->full)
+    upload_rect(page, 0, 0, h_res, v_res);
+  else {
+    upload_rects(&stale, page);
+    upload_rects(dirty, page);
+  }
+  blit_kernels()->stream_fence();
+  stale.num_rects = 0;
+  stale.full = false;
+}
+
 vbe_mode_info_t vmi_p; /**< VBE mode information */
 
 /**
@@ -42,7 +204,7 @@ void *(vg_init) (uint16_t mode) {
   bytes_per_pixel = (bits_per_pixel + 7) / 8;
   int r;
   vram_base = vmi_p.PhysBasePtr;
-  vram_size = 4 * vmi_p.XResolution * vmi_p.YResolution * bytes_per_pixel;
+  vram_size = 2 * vmi_p.XResolution * vmi_p.YResolution * bytes_per_pixel;
 
   mr.mr_base = (phys_bytes) vram_base;
   mr.mr_limit = mr.mr_base + vram_size;
@@ -55,10 +217,22 @@ void *(vg_init) (uint16_t mode) {
   if (video_mem == MAP_FAILED)
     panic("couldn't map video memory");
 
-  first_buffer = video_mem;
-  second_buffer = video_mem + vmi_p.XResolution * vmi_p.YResolution * bytes_per_pixel;
-  arena_buffer = video_mem + vmi_p.XResolution * vmi_p.YResolution * bytes_per_pixel * 2;
+  // the buffers drawn on live in cached system memory, only the flips write to VRAM
+  vram_pages[0] = video_mem;
+  vram_pages[1] = video_mem + vmi_p.XResolution * vmi_p.YResolution * bytes_per_pixel;
+  size_t buffer_size = (size_t) vmi_p.XResolution * vmi_p.YResolution * VG_PIXEL_BYTES;
+  if (first_buffer == NULL && (first_buffer = malloc(4 * buffer_size)) == NULL)
+    panic("couldn't allocate the drawing buffers");
+  second_buffer = first_buffer + buffer_size;
+  arena_buffer = first_buffer + buffer_size * 2;
+  menu_buffer = first_buffer + buffer_size * 3;
+#ifdef VG_RGB565
+  init_expansion();
+#endif
+  background_buffer = arena_buffer;
   drawing_buffer = second_buffer;
+  vg_background_changed();
+  blit_init();
   memset(&r86, 0, sizeof(r86));
 
   r86.ax = 0x4F02;
@@ -73,10 +247,51 @@ void *(vg_init) (uint16_t mode) {
   return NULL;
 }
 
+/**
+ * @brief Writes a colour in the pixel format of the buffers drawn on
+ *
+ * @param pixel The pixel to write
+ * @param color The colour, as 0xRRGGBB
+ */
+
+void vg_pack_pixel(char *pixel, uint32_t color) {
+#ifdef VG_RGB565
+  uint16_t packed = ((color >> 8) & 0xF800) | ((color >> 5) & 0x07E0) | ((color >> 3) & 0x001F);
+  pixel[0] = packed & 0xFF;
+  pixel[1] = packed >> 8;
+#else
+  pixel[0] = color & 0xFF;
+  pixel[1] = (color >> 8) & 0xFF;
+  pixel[2] = (color >> 16) & 0xFF;
+#endif
+}
+
+/**
+ * @brief Converts a decoded pixmap to the pixel format of the buffers drawn on
+ *
+ * The pixmap is converted in place and keeps its allocation. Its spans must
+ * be compiled before, since the transparency colour is only told apart in
+ * XPM_8_8_8. Without VG_RGB565 nothing is done.
+ *
+ * @param map The pixmap, in XPM_8_8_8
+ * @param num_pixels The number of pixels of the pixmap
+ */
+
+void vg_pack_pixmap(uint8_t *map, size_t num_pixels) {
+#ifdef VG_RGB565
+  for (size_t i = 0; i < num_pixels; i++) {
+    const uint8_t *src = map + i * 3;
+    vg_pack_pixel((char *) map + i * VG_PIXEL_BYTES, src[0] | (src[1] << 8) | (src[2] << 16));
+  }
+#endif
+}
+
 /**
  * @brief Draws a pixel at a specified location
  *
  * This function sets the color of the pixel at the specified (x, y) location.
+ * The pixel is not marked as drawn over, callers do that for the whole area
+ * they draw (see vg_mark_dirty()).
  *
  * @param x The x-coordinate of the pixel
  * @param y The y-coordinate of the pixel
@@ -85,14 +300,66 @@ void *(vg_init) (uint16_t mode) {
  */
 
 int(vg_draw_pixel)(uint16_t x, uint16_t y, uint32_t color) {
-  memcpy(&drawing_buffer[bytes_per_pixel * (vmi_p.XResolution * y + x)], &color, bytes_per_pixel);
+  vg_pack_pixel(&drawing_buffer[VG_PIXEL_BYTES * (h_res * y + x)], color);
   return 0;
 }
 
+/**
+ * @brief Fills a rectangle of a buffer with a colour
+ *
+ * The rectangle is clipped to the screen once, then each row is written
+ * whole: with memset() for black, otherwise by the fill kernel with the
+ * colour repeated in a pattern. Nothing is marked as drawn over, which suits
+ * the arena and menu buffers; use vg_fill_rect() on the drawing buffer.
+ *
+ * @param buffer The buffer, with the dimensions of the screen
+ * @param x The x-coordinate of the rectangle, may be off the screen
+ * @param y The y-coordinate of the rectangle, may be off the screen
+ * @param width The width of the rectangle
+ * @param height The height of the rectangle
+ * @param color The colour, as 0xRRGGBB
+ */
+
+void vg_fill_rect_to_buffer(char *buffer, int x, int y, int width, int height, uint32_t color) {
+  if (!clip_rect(&x, &y, &width, &height))
+    return;
+  unsigned pitch = h_res * VG_PIXEL_BYTES;
+  char *row = buffer + y * pitch + x * VG_PIXEL_BYTES;
+  if (color == 0) {
+    for (int i = 0; i < height; i++, row += pitch)
+      memset(row, 0, width * VG_PIXEL_BYTES);
+    return;
+  }
+  uint8_t pattern[BLIT_PATTERN_LEN];
+  blit_make_pattern(pattern, color);
+  const BlitKernels *blit = blit_kernels();
+  for (int i = 0; i < height; i++, row += pitch)
+    blit->fill(row, pattern, width * VG_PIXEL_BYTES);
+}
+
+/**
+ * @brief Fills a rectangle of the drawing buffer with a colour
+ *
+ * The rectangle is clipped to the screen and marked as drawn over, so it can
+ * be used for bars, highlights and boxes drawn every frame.
+ *
+ * @param x The x-coordinate of the rectangle, may be off the screen
+ * @param y The y-coordinate of the rectangle, may be off the screen
+ * @param width The width of the rectangle
+ * @param height The height of the rectangle
+ * @param color The colour, as 0xRRGGBB
+ */
+
+void vg_fill_rect(int x, int y, int width, int height, uint32_t color) {
+  vg_fill_rect_to_buffer(drawing_buffer, x, y, width, height, color);
+  vg_mark_dirty(x, y, width, height);
+}
+
 /**
  * @brief Draws a horizontal line
  *
- * This function draws a horizontal line starting from the specified (x, y) position.
+ * This function draws a horizontal line starting from the specified (x, y) position,
+ * clipped to the screen.
  *
  * @param x The starting x-coordinate of the line
  * @param y The starting y-coordinate of the line
@@ -102,18 +369,15 @@ int(vg_draw_pixel)(uint16_t x, uint16_t y, uint32_t color) {
  */
 
 int(vg_draw_hline)(uint16_t x, uint16_t y, uint16_t len, uint32_t color) {
-  uint16_t tempX = x;
-  while (tempX < x + len) {
-    vg_draw_pixel(tempX, y, color);
-    tempX++;
-  }
+  vg_fill_rect(x, y, len, 1, color);
   return 0;
 }
 
 /**
  * @brief Draws a rectangle
  *
- * This function draws a rectangle starting from the specified (x, y) position.
+ * This function draws a rectangle starting from the specified (x, y) position,
+ * clipped to the screen.
  *
  * @param x The x-coordinate of the rectangle
  * @param y The y-coordinate of the rectangle
@@ -124,11 +388,7 @@ int(vg_draw_hline)(uint16_t x, uint16_t y, uint16_t len, uint32_t color) {
  */
 
 int(vg_draw_rectangle)(uint16_t x, uint16_t y, u_int16_t width, u_int16_t height, uint32_t color) {
-  uint16_t tempY = y;
-  while (tempY < y + height) {
-    vg_draw_hline(x, tempY, width, color);
-    tempY++;
-  }
+  vg_fill_rect(x, y, width, height, color);
   return 0;
 }
 
@@ -205,45 +465,7 @@ int(vg_draw_pixmap)(xpm_map_t xpm, uint16_t x, uint16_t y) {
       desl += 3;
     }
   }
-  return 0;
-}
-
-/**
- * @brief Draws an arena pixmap
- *
- * This function draws a pixmap at the specified (x, y) position onto the arena buffer.
- *
- * @param xpm The XPM image to draw
- * @param x The x-coordinate of the top-left corner of the pixmap
- * @param y The y-coordinate of the top-left corner of the pixmap
- * @param ground_color The color representing the ground
- * @return Returns 0
- */
-
-int(vg_draw_arena_xpm)(xpm_map_t xpm, uint16_t x, uint16_t y, uint32_t ground_color) {
-  char *buffer = arena_buffer;
-  xpm_image_t img;
-  unsigned char *map;
-  map = xpm_load(xpm, XPM_8_8_8, &img);
-  uint32_t color;
-  uint32_t desl;
-  int color_index;
-  uint16_t height = img.height;
-  uint16_t width = img.width;
-  for (int i = 0; i < height; i++) {
-    for (int j = 0; j < width; j++) {
-      desl = (i * width + j) * 3;
-      color = map[desl] | (map[desl + 1] << 8) | (map[desl + 2] << 16);
-      if (color != ground_color) {
-      }
-      if (color != xpm_transparency_color(XPM_8_8_8)) {
-        color_index = (h_res * (y + i) + (x + j)) * 3;
-        buffer[color_index] = color & 0xFF;
-        buffer[color_index + 1] = (color >> 8) & 0xFF;
-        buffer[color_index + 2] = (color >> 16) & 0xFF;
-      }
-    }
-  }
+  vg_mark_dirty(x, y, img.width, img.height);
   return 0;
 }
 
@@ -311,14 +533,144 @@ int(vg_move_pixmap)(xpm_map_t xpm, uint16_t *current_x, uint16_t *current_y, uin
   return 0;
 }
 
+/**
+ * @brief Adds a region to the regions drawn over a buffer
+ *
+ * The region is clipped to the screen. Past MAX_DIRTY_RECTS regions the whole
+ * buffer is restored instead.
+ *
+ * @param dirty The regions of the buffer
+ * @param x The x-coordinate of the region
+ * @param y The y-coordinate of the region
+ * @param width The width of the region
+ * @param height The height of the region
+ */
+
+static void add_dirty_rect(DirtyRects *dirty, int x, int y, int width, int height) {
+  if (dirty->full || !clip_rect(&x, &y, &width, &height))
+    return;
+
+  if (dirty->num_rects == MAX_DIRTY_RECTS) {
+    dirty->full = true;
+    return;
+  }
+  dirty->x[dirty->num_rects] = x;
+  dirty->y[dirty->num_rects] = y;
+  dirty->width[dirty->num_rects] = width;
+  dirty->height[dirty->num_rects] = height;
+  dirty->num_rects++;
+}
+
+/**
+ * @brief Marks a region of the drawing buffer as drawn over
+ *
+ * Every drawing function calls this with the area it touched, so that the
+ * next time this buffer is drawn on only those areas are restored from the
+ * background. The region is clipped to the screen.
+ *
+ * @param x The x-coordinate of the region
+ * @param y The y-coordinate of the region
+ * @param width The width of the region
+ * @param height The height of the region
+ */
+
+void vg_mark_dirty(int x, int y, int width, int height) {
+  add_dirty_rect(drawing_first_buffer ? &first_dirty : &second_dirty, x, y, width, height);
+}
+
+/**
+ * @brief Tells that a region of the background was redrawn
+ *
+ * The drawing buffer was already restored by the last flip, so the region is
+ * copied to it at once. The displayed buffer gets it when it is restored.
+ * Anything drawn over the region in this frame must be drawn afterwards.
+ *
+ * @param x The x-coordinate of the region, which must lie on the screen
+ * @param y The y-coordinate of the region
+ * @param width The width of the region
+ * @param height The height of the region
+ */
+
+void vg_background_updated(int x, int y, int width, int height) {
+  unsigned pitch = h_res * VG_PIXEL_BYTES;
+  unsigned offset = y * pitch + x * VG_PIXEL_BYTES;
+  const BlitKernels *blit = blit_kernels();
+  for (int row = 0; row < height; row++, offset += pitch)
+    blit->copy(drawing_buffer + offset, background_buffer + offset, width * VG_PIXEL_BYTES);
+  add_dirty_rect(drawing_first_buffer ? &second_dirty : &first_dirty, x, y, width, height);
+  add_dirty_rect(&stale, x, y, width, height);
+}
+
+/**
+ * @brief Tells that the background was redrawn
+ *
+ * Both double buffers hold the old background, so each of them is fully
+ * restored the next time it is drawn on.
+ */
+
+void vg_background_changed() {
+  first_dirty.full = true;
+  second_dirty.full = true;
+}
+
+/**
+ * @brief Chooses the buffer the double buffers are restored from
+ *
+ * The arena buffer holds the background of the game, the menu buffer that of
+ * a menu. Choosing another buffer restores both double buffers whole.
+ *
+ * @param buffer The arena or the menu buffer
+ */
+
+void vg_set_background(char *buffer) {
+  if (buffer != background_buffer) {
+    background_buffer = buffer;
+    vg_background_changed();
+  }
+}
+
+/**
+ * @brief Restores the drawing buffer to the background
+ *
+ * Only the regions drawn on this buffer two frames ago (when it was last
+ * drawn on) hold something else than the background, so only those are
+ * copied, row by row. They are kept to be uploaded to VRAM by the next flip.
+ */
+
+static void restore_background() {
+  DirtyRects *dirty = drawing_first_buffer ? &first_dirty : &second_dirty;
+  const BlitKernels *blit = blit_kernels();
+  unsigned pitch = h_res * VG_PIXEL_BYTES;
+  if (dirty->full) {
+    blit->copy(drawing_buffer, background_buffer, pitch * v_res);
+    restored_bytes = pitch * v_res;
+  }
+  else {
+    restored_bytes = 0;
+    for (int i = 0; i < dirty->num_rects; i++) {
+      unsigned offset = dirty->y[i] * pitch + dirty->x[i] * VG_PIXEL_BYTES;
+      unsigned len = dirty->width[i] * VG_PIXEL_BYTES;
+      for (int row = 0; row < dirty->height[i]; row++, offset += pitch)
+        blit->copy(drawing_buffer + offset, background_buffer + offset, len);
+      restored_bytes += len * dirty->height[i];
+    }
+  }
+  stale = *dirty;
+  dirty->num_rects = 0;
+  dirty->full = false;
+}
+
 /**
  * @brief Flips the display buffers
  *
- * This function flips the display buffers to show the buffer that was just drawn to.
+ * This function flips the display buffers to show the buffer that was just drawn to,
+ * then restores the regions of the new drawing buffer that were drawn over.
+ * The changed regions of the buffer are first uploaded to its VRAM page.
  *
  * @return Returns 0 on success, -1 on failure
  */
 int vg_flip_buffers() {
+  present_drawing_buffer();
   reg86_t r86;
   memset(&r86, 0, sizeof(r86));
   r86.intno = 0x10;
@@ -333,7 +685,7 @@ int vg_flip_buffers() {
   }
   drawing_first_buffer = !drawing_first_buffer;                         // flip buffers
   drawing_buffer = drawing_first_buffer ? first_buffer : second_buffer; // flip buffers
-  memcpy(drawing_buffer, arena_buffer, h_res * v_res * bytes_per_pixel);
+  restore_background();
 
   return 0;
 }
@@ -347,7 +699,13 @@ int vg_flip_buffers() {
  */
 
 void vg_clear_buffer(char *buffer) {
-  memset(buffer, 0, h_res * v_res * bytes_per_pixel);
+  memset(buffer, 0, h_res * v_res * VG_PIXEL_BYTES);
+  if (buffer == background_buffer)
+    vg_background_changed();
+  else if (buffer == first_buffer)
+    first_dirty.full = true;
+  else if (buffer == second_buffer)
+    second_dirty.full = true;
 }
 
 /**
@@ -395,6 +753,17 @@ char *get_arena_buffer() {
   return arena_buffer;
 }
 
+/**
+ * @brief Gets the menu buffer
+ *
+ * This function returns a pointer to the buffer menus compose their static layer in.
+ *
+ * @return Pointer to the menu buffer
+ */
+char *get_menu_buffer() {
+  return menu_buffer;
+}
+
 /**
  * @brief Gets the horizontal resolution
  *
@@ -405,3 +774,44 @@ char *get_arena_buffer() {
 unsigned get_h_res() {
   return h_res;
 }
+
+/**
+ * @brief Gets the vertical resolution
+ *
+ * This function returns the vertical resolution.
+ *
+ * @return Vertical resolution
+ */
+unsigned get_v_res() {
+  return v_res;
+}
+
+/**
+ * @brief Gets the amount of background restored by the last flip
+ *
+ * @return Number of bytes copied from the background
+ */
+unsigned get_restored_bytes() {
+  return restored_bytes;
+}
+
+/**
+ * @brief Gets the amount of VRAM written by the last flip
+ *
+ * @return Number of bytes uploaded to the page shown
+ */
+unsigned get_uploaded_bytes() {
+  return uploaded_bytes;
+}
+
+/**
+ * @brief Gets a VRAM page
+ *
+ * Nothing but the flips writes to the pages, the benchmarks excepted.
+ *
+ * @param page 0 for the page of the first buffer, 1 for that of the second
+ * @return Pointer to the page, in the mapped VRAM
+ */
+char *get_vram_page(int page) {
+  return vram_pages[page];
+}
@@ -5,16 +5,36 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#define MAX_DIRTY_RECTS 128 /**< Regions tracked per buffer before restoring it whole */
+
+/* The buffers the game draws on (the double buffers, the arena and the menu
+ * buffer) live in system memory and hold the 24 bit pixels of mode 0x115.
+ * vg_flip_buffers() uploads what changed in a double buffer to its VRAM page,
+ * so VRAM is only ever written, in whole rows. Built with VG_RGB565 they hold
+ * 16 bit 5:6:5 pixels instead, expanded to 24 bit by the upload. */
+#ifdef VG_RGB565
+#define VG_PIXEL_BYTES 2 /**< Bytes per pixel of the buffers drawn on */
+#else
+#define VG_PIXEL_BYTES 3 /**< Bytes per pixel of the buffers drawn on */
+#endif
 
 
 void *(vg_init) (uint16_t mode);
 
+void vg_pack_pixel(char *pixel, uint32_t color);
+
+void vg_pack_pixmap(uint8_t *map, size_t num_pixels);
+
 int(vg_draw_pixel)(uint16_t x, uint16_t y, uint32_t color);
 
 int(vg_draw_hline)(uint16_t x, uint16_t y, uint16_t len, uint32_t color);
 
 int(vg_draw_rectangle)(uint16_t x, uint16_t y, u_int16_t width, u_int16_t height, uint32_t color);
 
+void vg_fill_rect(int x, int y, int width, int height, uint32_t color);
+
+void vg_fill_rect_to_buffer(char *buffer, int x, int y, int width, int height, uint32_t color);
+
 int(vg_draw_pattern)(uint8_t no_rectangles, uint32_t first, uint8_t step, uint16_t mode);
 
 int(vg_draw_pixmap)(xpm_map_t xpm, uint16_t x, uint16_t y);
@@ -26,12 +46,25 @@ int(vg_move_pixmap)(xpm_map_t xpm, uint16_t *current_x, uint16_t *current_y, uin
 
 int vg_flip_buffers();
 
+void vg_mark_dirty(int x, int y, int width, int height);
+
+void vg_background_changed();
+
+void vg_background_updated(int x, int y, int width, int height);
+
+void vg_set_background(char *buffer);
+
 void vg_clear_buffer(char* buffer);
 
 char* get_first_buffer();
 char* get_second_buffer();
 char* get_drawing_buffer();
 char* get_arena_buffer();
+char* get_menu_buffer();
 unsigned get_h_res();
+unsigned get_v_res();
+unsigned get_restored_bytes();
+unsigned get_uploaded_bytes();
+char* get_vram_page(int page);
 
 #endif
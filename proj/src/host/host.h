@@ -0,0 +1,72 @@
+#ifndef _HOST_H_
+#define _HOST_H_
+
+/** @file host.h
+ *  @brief Headless Linux platform layer
+ *
+ *  The host build compiles the game unchanged against lcom/lcf.h from this
+ *  directory and links it with these files instead of LCF:
+ *  - host_lcf.c: the MINIX and LCF entry points. VRAM is a malloc'd buffer and
+ *    driver_receive() turns the script into interrupt notifications.
+ *  - host_kbc.c: the i8042 (KBC) and i8254 ports behind sys_inb()/sys_outb().
+ *  - host_script.c: the scripted timer, keyboard and mouse streams.
+ *  - host_xpm.c: xpm_load().
+ *  - host_alloc.c: counts the heap allocations for the benchmarks.
+ *
+ *  Usage: proj [-s script] [-t ticks] [benchmark args...]
+ */
+
+#include <lcom/lcf.h>
+
+#define HOST_MAX_EVENTS 4096     ///< events a script can hold
+#define HOST_MAX_EVENT_BYTES 4   ///< scancode bytes of one key event
+
+/** @brief What a script line does */
+typedef enum {
+  HOST_KEY,   ///< bytes go through the KBC as keyboard data
+  HOST_MOUSE, ///< a PS/2 packet goes through the KBC as mouse data
+  HOST_PARITY, ///< bytes go through the KBC as keyboard data with a parity error
+  HOST_DUMP   ///< the displayed page is written to a PPM file
+} HostEventType;
+
+/** @brief One script line */
+typedef struct {
+  uint32_t tick;          ///< timer interrupt the event follows
+  HostEventType type;
+  uint8_t size;           ///< number of bytes
+  uint8_t bytes[HOST_MAX_EVENT_BYTES];
+  char *path;             ///< file of a HOST_DUMP event
+} HostEvent;
+
+/* host_script.c */
+
+/** Reads a script, returns 0 on success */
+int host_load_script(const char *path);
+
+/** Last tick of the script */
+uint32_t host_script_end();
+
+/** Returns the next event of tick "tick", NULL once they have all been returned */
+const HostEvent *host_next_event(uint32_t tick);
+
+/** Frees the script */
+void host_free_script();
+
+/* host_kbc.c */
+
+/** Queues a byte in the KBC output buffer with the AUX and error bits of its status */
+void host_kbc_push(uint8_t byte, uint8_t status);
+
+/** Loads the next queued byte in the output buffer if it is empty and returns
+ *  the IRQ of the bytes loaded since the last call, -1 if there are none */
+int host_kbc_deliver();
+
+/** Number of sys_inb() and sys_outb() calls on the KBC ports */
+unsigned host_kbc_io_count();
+
+/* host_lcf.c */
+
+/** Writes the displayed page to a binary PPM file, returns 0 on success */
+int host_dump_frame(const char *path);
+
+#endif
@@ -0,0 +1,53 @@
+/**
+ * @file host_alloc.c
+ * @brief Heap allocation counters for the host build
+ *
+ * The host Makefile links with --wrap for malloc(), calloc(), realloc() and
+ * free(), so every call made by the game goes through these counters.
+ */
+
+#include "host.h"
+#include "../bench/bench.h"
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static unsigned long num_allocs; /**< Calls to malloc(), calloc() and realloc() */
+static unsigned long num_frees;  /**< Calls to free() with a non NULL pointer */
+
+void *__wrap_malloc(size_t size) {
+  num_allocs++;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size) {
+  num_allocs++;
+  return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  num_allocs++;
+  return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+  if (ptr != NULL)
+    num_frees++;
+  __real_free(ptr);
+}
+
+/**
+ * @brief Gets the number of heap allocations so far
+ *
+ * @param allocs Receives the calls to malloc(), calloc() and realloc()
+ * @param frees Receives the calls to free()
+ * @return 0
+ */
+
+int bench_alloc_counts(unsigned long *allocs, unsigned long *frees) {
+  *allocs = num_allocs;
+  *frees = num_frees;
+  return 0;
+}
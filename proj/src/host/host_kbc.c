@@ -0,0 +1,167 @@
+/**
+ * @file host_kbc.c
+ * @brief Port model of the i8042 keyboard controller and i8254 timer for the host build
+ *
+ * Scripted keyboard and mouse bytes wait in a queue and are moved to the
+ * output buffer one at a time, each raising its interrupt, as the KBC does.
+ * The next byte is loaded as soon as the output buffer is read, so bytes
+ * queued together arrive as a burst the driver must drain, keyboard and mouse
+ * interleaved. A byte can carry a parity error in the status register.
+ * Command replies (command byte, mouse ACK) are placed in the output buffer
+ * right away since the driver polls for them.
+ */
+
+#include "host.h"
+#include "../device/i8042.h"
+#include "../device/i8254.h"
+
+#define KBC_QUEUE_SIZE 1024
+
+static uint8_t queue_bytes[KBC_QUEUE_SIZE];  /**< Bytes waiting for the output buffer */
+static uint8_t queue_status[KBC_QUEUE_SIZE]; /**< AUX and error bits of each byte */
+static unsigned queue_head, queue_tail;
+
+static uint8_t out_buf;           /**< Output buffer (port 0x60) */
+static bool out_full;             /**< OBF bit of the status register */
+static uint8_t out_status;        /**< AUX and error bits of the status register */
+static bool irq_raised;           /**< A byte was loaded since the last interrupt */
+static uint8_t command_byte = 0x47; /**< KBC command byte, interrupts enabled */
+static uint8_t pending_cmd;       /**< Command waiting for its argument on port 0x60 */
+static uint8_t timer_conf[3] = {0x36, 0x36, 0x36}; /**< Control words of the timers */
+static uint8_t readback;          /**< Timers selected by the last read-back command */
+static unsigned io_count;         /**< KBC port accesses */
+
+/**
+ * @brief Queues a byte in the KBC output buffer
+ *
+ * @param byte The byte
+ * @param status KBC_ST_AUX if it comes from the mouse, plus KBC_ST_PAR_ERR
+ * or KBC_ST_TO_ERR to receive it with an error
+ */
+
+void host_kbc_push(uint8_t byte, uint8_t status) {
+  if (queue_tail - queue_head == KBC_QUEUE_SIZE)
+    return;
+  queue_bytes[queue_tail % KBC_QUEUE_SIZE] = byte;
+  queue_status[queue_tail % KBC_QUEUE_SIZE] = status;
+  queue_tail++;
+}
+
+/**
+ * @brief Moves the next queued byte to the output buffer, if it is empty
+ */
+
+static void load_next() {
+  if (out_full || queue_head == queue_tail)
+    return;
+  out_buf = queue_bytes[queue_head % KBC_QUEUE_SIZE];
+  out_status = queue_status[queue_head % KBC_QUEUE_SIZE];
+  out_full = true;
+  irq_raised = true;
+  queue_head++;
+}
+
+/**
+ * @brief Raises the interrupt of the bytes loaded in the output buffer
+ *
+ * The line is that of the byte in the buffer, or of the last one loaded if
+ * the driver already read it.
+ *
+ * @return The IRQ line raised, or -1 if no byte was loaded since the last one
+ */
+
+int host_kbc_deliver() {
+  load_next();
+  if (!irq_raised)
+    return -1;
+  irq_raised = false;
+  return out_status & KBC_ST_AUX ? MOUSE_IRQ : KEYBOARD_IRQ;
+}
+
+/**
+ * @brief Gets the number of accesses to the KBC ports
+ */
+
+unsigned host_kbc_io_count() {
+  return io_count;
+}
+
+/**
+ * @brief Places a command reply in the output buffer
+ */
+
+static void reply(uint8_t byte, bool aux) {
+  out_buf = byte;
+  out_status = aux ? KBC_ST_AUX : 0;
+  out_full = true;
+}
+
+/**
+ * @brief Reads a port
+ *
+ * @param port The port
+ * @param value Receives the value read
+ * @return 0
+ */
+
+int sys_inb(int port, u32_t *value) {
+  switch (port) {
+    case KBC_ST_REG:
+      io_count++;
+      *value = out_full ? KBC_ST_OBF | out_status : 0;
+      break;
+    case KBC_OUT_BUF:
+      io_count++;
+      *value = out_buf;
+      out_full = false;
+      load_next();
+      break;
+    case TIMER_0:
+    case TIMER_1:
+    case TIMER_2:
+      *value = readback & BIT(port - TIMER_0 + 1) ? timer_conf[port - TIMER_0] : 0;
+      break;
+    default:
+      *value = 0;
+      break;
+  }
+  return OK;
+}
+
+/**
+ * @brief Writes a port
+ *
+ * @param port The port
+ * @param value The value to write
+ * @return 0
+ */
+
+int sys_outb(int port, u32_t value) {
+  switch (port) {
+    case KBC_CMD_REG:
+      io_count++;
+      pending_cmd = 0;
+      if (value == KBC_READ_CMD_BYTE)
+        reply(command_byte, false);
+      else if (value == KBC_WRITE_CMD_BYTE || value == WRITE_BYTE_MOUSE_CMD)
+        pending_cmd = value;
+      break;
+    case KBC_IN_BUF:
+      io_count++;
+      if (pending_cmd == KBC_WRITE_CMD_BYTE)
+        command_byte = value;
+      else if (pending_cmd == WRITE_BYTE_MOUSE_CMD)
+        reply(ACK_BYTE, true);
+      pending_cmd = 0;
+      break;
+    case TIMER_CTRL:
+      if ((value & TIMER_RB_CMD) == TIMER_RB_CMD)
+        readback = value & 0x0E;
+      else if ((value >> 6) < 3)
+        timer_conf[value >> 6] = value & 0x3F;
+      break;
+    default:
+      break;
+  }
+  return OK;
+}
@@ -0,0 +1,291 @@
+/**
+ * @file host_lcf.c
+ * @brief MINIX and LCF entry points for the host build
+ *
+ * VRAM is a buffer in system memory, the VBE calls only record the page being
+ * displayed, and driver_receive() plays the script: each call returns either the
+ * interrupt of a KBC byte loaded in the output buffer, or the next timer interrupt,
+ * after queueing the events of that tick. The run stops when the game exits or
+ * the script runs out of ticks, and prints how fast the ticks went.
+ */
+
+#include <stdarg.h>
+#include "host.h"
+#include "../bench/bench.h"
+#include "../device/i8042.h"
+#include "../device/i8254.h"
+#include "../device/kbc.h"
+
+#define NUM_IRQS 16
+
+static char *vram;             /**< The "video memory" */
+static size_t vram_size;       /**< Its size in bytes */
+static vbe_mode_info_t mode_info; /**< The mode set by vg_init() */
+static unsigned display_line;  /**< First line of the displayed page */
+static unsigned num_flips;     /**< Page flips requested by the game */
+
+static int irq_hooks[NUM_IRQS];      /**< Hook id of each IRQ line */
+static bool irq_subscribed[NUM_IRQS]; /**< Whether the game subscribed the IRQ line */
+
+static uint32_t tick;          /**< Timer interrupts delivered */
+static uint32_t last_tick;     /**< Tick after which the run stops */
+static uint64_t start_us;      /**< Time of the first interrupt */
+
+/**
+ * @brief Gets a monotonic time in microseconds
+ */
+
+static uint64_t now_us() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief Prints how many ticks and frames were run, and how fast, and how many
+ * heap blocks are still allocated
+ */
+
+static void report() {
+  double elapsed_us = now_us() - start_us;
+  unsigned long allocs, frees;
+  if (elapsed_us <= 0)
+    elapsed_us = 1;
+  bench_alloc_counts(&allocs, &frees);
+  fprintf(stderr, "host: %u ticks, %u frames in %.1f ms (%.1f us/tick, %.0f frames/s), %u KBC accesses, "
+          "%u KBC bytes dropped, %lu heap blocks live\n",
+          tick, num_flips, elapsed_us / 1000, elapsed_us / (tick ? tick : 1),
+          num_flips * 1e6 / elapsed_us, host_kbc_io_count(), kbc_dropped_bytes(), allocs - frees);
+}
+
+/**
+ * @brief Writes the displayed page to a binary PPM file
+ *
+ * @param path The file to write
+ * @return 0 on success, 1 otherwise
+ */
+
+int host_dump_frame(const char *path) {
+  unsigned width = mode_info.XResolution, height = mode_info.YResolution;
+  unsigned bytes_per_pixel = (mode_info.BitsPerPixel + 7) / 8;
+  if (vram == NULL || bytes_per_pixel != 3)
+    return 1;
+  FILE *file = fopen(path, "wb");
+  if (file == NULL)
+    return 1;
+  fprintf(file, "P6\n%u %u\n255\n", width, height);
+  const uint8_t *page = (const uint8_t *) vram + (size_t) display_line * width * 3;
+  for (size_t i = 0; i < (size_t) width * height; i++) {
+    const uint8_t rgb[3] = {page[i * 3 + 2], page[i * 3 + 1], page[i * 3]};
+    fwrite(rgb, 1, 3, file);
+  }
+  fclose(file);
+  return 0;
+}
+
+/**
+ * @brief Hands one script event to the KBC or the display
+ */
+
+static void play_event(const HostEvent *event) {
+  switch (event->type) {
+    case HOST_KEY:
+      for (int i = 0; i < event->size; i++)
+        host_kbc_push(event->bytes[i], 0);
+      break;
+    case HOST_PARITY:
+      for (int i = 0; i < event->size; i++)
+        host_kbc_push(event->bytes[i], KBC_ST_PAR_ERR);
+      break;
+    case HOST_MOUSE:
+      for (int i = 0; i < event->size; i++)
+        host_kbc_push(event->bytes[i], KBC_ST_AUX);
+      break;
+    case HOST_DUMP:
+      if (host_dump_frame(event->path) != 0)
+        fprintf(stderr, "host: cannot write %s\n", event->path);
+      break;
+  }
+}
+
+/**
+ * @brief Receives the next interrupt notification
+ *
+ * @param src Ignored
+ * @param m_ptr Receives the notification
+ * @param status_ptr Receives the IPC status
+ * @return 0
+ */
+
+int driver_receive(endpoint_t src, message *m_ptr, int *status_ptr) {
+  if (start_us == 0)
+    start_us = now_us();
+  int irq = host_kbc_deliver();
+  if (irq < 0) {
+    if (tick > last_tick) {
+      report();
+      fprintf(stderr, "host: script ended before the game exited\n");
+      exit(0);
+    }
+    const HostEvent *event;
+    while ((event = host_next_event(tick)) != NULL)
+      play_event(event);
+    tick++;
+    irq = TIMER0_IRQ;
+  }
+
+  m_ptr->m_source = HARDWARE;
+  m_ptr->m_notify.interrupts = irq_subscribed[irq] ? BIT(irq_hooks[irq]) : 0;
+  *status_ptr = 1;
+  return OK;
+}
+
+int sys_irqsetpolicy(int irq_vec, int policy, int *irq_hook_id) {
+  if (irq_vec < 0 || irq_vec >= NUM_IRQS)
+    return 1;
+  irq_hooks[irq_vec] = *irq_hook_id;
+  irq_subscribed[irq_vec] = true;
+  return OK;
+}
+
+int sys_irqrmpolicy(int *irq_hook_id) {
+  for (int i = 0; i < NUM_IRQS; i++) {
+    if (irq_subscribed[i] && irq_hooks[i] == *irq_hook_id) {
+      irq_subscribed[i] = false;
+      return OK;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief Waits for the KBC: the port model answers at once, so nothing to do
+ */
+
+int tickdelay(clock_t ticks) {
+  return OK;
+}
+
+u32_t micros_to_ticks(u32_t micros) {
+  return micros * 60 / 1000000;
+}
+
+int sys_privctl(endpoint_t proc_ep, int req, void *p) {
+  return OK;
+}
+
+/**
+ * @brief Maps the "video memory", allocating it on the first call
+ */
+
+void *vm_map_phys(endpoint_t who, void *physaddr, size_t len) {
+  if (vram == NULL) {
+    vram = calloc(len, 1);
+    vram_size = len;
+  }
+  return vram != NULL && len <= vram_size ? vram : MAP_FAILED;
+}
+
+/**
+ * @brief Returns the information of the direct colour modes of the LCOM VMs
+ */
+
+int(vbe_get_mode_info)(uint16_t mode, vbe_mode_info_t *vmi_p) {
+  static const struct {
+    uint16_t mode, width, height;
+    uint8_t bits, red, green, blue;
+  } modes[] = {
+    {0x110, 640, 480, 15, 5, 5, 5},
+    {0x115, 800, 600, 24, 8, 8, 8},
+    {0x11A, 1280, 1024, 16, 5, 6, 5},
+    {0x14C, 1152, 864, 32, 8, 8, 8},
+  };
+  for (unsigned i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+    if (modes[i].mode != mode)
+      continue;
+    memset(vmi_p, 0, sizeof(*vmi_p));
+    vmi_p->XResolution = modes[i].width;
+    vmi_p->YResolution = modes[i].height;
+    vmi_p->BitsPerPixel = modes[i].bits;
+    vmi_p->BlueMaskSize = modes[i].blue;
+    vmi_p->GreenMaskSize = modes[i].green;
+    vmi_p->GreenFieldPosition = modes[i].blue;
+    vmi_p->RedMaskSize = modes[i].red;
+    vmi_p->RedFieldPosition = modes[i].blue + modes[i].green;
+    vmi_p->PhysBasePtr = 0xE0000000;
+    mode_info = *vmi_p;
+    return OK;
+  }
+  return 1;
+}
+
+/**
+ * @brief Handles the VBE calls: set mode (0x4F02) and set display start (0x4F07)
+ */
+
+int sys_int86(reg86_t *reg86p) {
+  if (reg86p->intno != 0x10)
+    return 1;
+  if (reg86p->ax == 0x4F07) {
+    display_line = reg86p->dx;
+    num_flips++;
+  }
+  return OK;
+}
+
+int(vg_exit)() {
+  return OK;
+}
+
+int(timer_print_config)(uint8_t timer, enum timer_status_field field, union timer_status_field_val val) {
+  printf("timer %u: 0x%02x\n", timer, val.byte);
+  return OK;
+}
+
+void panic(const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+  exit(1);
+}
+
+/**
+ * @brief Parses the host options and runs the game or a benchmark
+ *
+ * Options are -s script and -t ticks (default: up to the last event of the
+ * script). Any other argument is passed to proj_main_loop().
+ */
+
+int lcf_start(int argc, char *argv[]) {
+  const char *script = NULL;
+  long ticks = -1;
+  int opt;
+  while ((opt = getopt(argc, argv, "+s:t:")) != -1) {
+    switch (opt) {
+      case 's':
+        script = optarg;
+        break;
+      case 't':
+        ticks = atol(optarg);
+        break;
+      default:
+        fprintf(stderr, "usage: %s [-s script] [-t ticks] [benchmark args...]\n", argv[0]);
+        return 1;
+    }
+  }
+  if (script != NULL && host_load_script(script) != 0)
+    return 1;
+  // the input of the last event is handled on the tick after it
+  last_tick = ticks >= 0 ? (uint32_t) ticks : host_script_end() + 1;
+  return proj_main_loop(argc - optind, argv + optind);
+}
+
+int lcf_cleanup() {
+  if (tick > 0)
+    report();
+  host_free_script();
+  free(vram);
+  vram = NULL;
+  return OK;
+}
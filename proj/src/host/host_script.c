@@ -0,0 +1,173 @@
+/**
+ * @file host_script.c
+ * @brief Scripted input streams for the host build
+ *
+ * A script has one event per line, after the timer interrupt it follows:
+ * <pre>
+ *   # tick  event
+ *   30      key 39 b9          scancode bytes, in hex
+ *   40      key e0 48 e0 c8
+ *   50      mouse 10 -4 l      PS/2 deltas (y grows upwards) and buttons l, r, m or -
+ *   55      parity b9          scancode bytes received with a parity error
+ *   60      dump frame.ppm     writes the displayed page
+ * </pre>
+ * Ticks must not decrease. Blank lines and lines starting with '#' are ignored.
+ */
+
+#include "host.h"
+#include "../device/i8042.h"
+
+static HostEvent events[HOST_MAX_EVENTS]; /**< The script */
+static int num_events;                    /**< Number of events in the script */
+static int next_event;                    /**< First event not returned yet */
+
+/**
+ * @brief Parses the arguments of a key event
+ *
+ * @param event The event to fill
+ * @param args The scancode bytes
+ * @return 0 on success, 1 otherwise
+ */
+
+static int parse_key(HostEvent *event, char *args) {
+  char *token = strtok(args, " \t\n");
+  event->size = 0;
+  while (token != NULL) {
+    char *end;
+    unsigned long byte = strtoul(token, &end, 16);
+    if (*end != '\0' || byte > 0xFF || event->size == HOST_MAX_EVENT_BYTES)
+      return 1;
+    event->bytes[event->size++] = byte;
+    token = strtok(NULL, " \t\n");
+  }
+  return event->size == 0;
+}
+
+/**
+ * @brief Parses the arguments of a mouse event into a PS/2 packet
+ *
+ * @param event The event to fill
+ * @param args The deltas and buttons
+ * @return 0 on success, 1 otherwise
+ */
+
+static int parse_mouse(HostEvent *event, char *args) {
+  int dx, dy;
+  char buttons[4] = "-";
+  if (sscanf(args, "%d %d %3s", &dx, &dy, buttons) < 2)
+    return 1;
+  dx = dx < -256 ? -256 : dx > 255 ? 255 : dx;
+  dy = dy < -256 ? -256 : dy > 255 ? 255 : dy;
+
+  uint8_t first = BIT(3);
+  if (strchr(buttons, 'l'))
+    first |= LEFT_BUTTON;
+  if (strchr(buttons, 'r'))
+    first |= RIGHT_BUTTON;
+  if (strchr(buttons, 'm'))
+    first |= MIDDLE_BUTTON;
+  if (dx < 0)
+    first |= MSB_X_DELTA;
+  if (dy < 0)
+    first |= MSB_Y_DELTA;
+  event->size = 3;
+  event->bytes[0] = first;
+  event->bytes[1] = dx & 0xFF;
+  event->bytes[2] = dy & 0xFF;
+  return 0;
+}
+
+/**
+ * @brief Reads a script
+ *
+ * @param path The script file
+ * @return 0 on success, 1 otherwise
+ */
+
+int host_load_script(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    fprintf(stderr, "host: cannot open %s\n", path);
+    return 1;
+  }
+  char line[256];
+  int line_no = 0;
+  host_free_script();
+
+  while (fgets(line, sizeof(line), file) != NULL) {
+    line_no++;
+    unsigned tick;
+    char type[16];
+    int offset;
+    if (sscanf(line, " %15s", type) != 1 || type[0] == '#')
+      continue;
+    if (sscanf(line, "%u %15s %n", &tick, type, &offset) != 2 || num_events == HOST_MAX_EVENTS ||
+        (num_events > 0 && tick < events[num_events - 1].tick)) {
+      fprintf(stderr, "host: %s:%d: invalid event\n", path, line_no);
+      fclose(file);
+      return 1;
+    }
+
+    HostEvent *event = &events[num_events];
+    char *args = line + offset;
+    int error;
+    event->tick = tick;
+    event->path = NULL;
+    if (strcmp(type, "key") == 0 || strcmp(type, "parity") == 0) {
+      event->type = type[0] == 'k' ? HOST_KEY : HOST_PARITY;
+      error = parse_key(event, args);
+    }
+    else if (strcmp(type, "mouse") == 0) {
+      event->type = HOST_MOUSE;
+      error = parse_mouse(event, args);
+    }
+    else if (strcmp(type, "dump") == 0) {
+      event->type = HOST_DUMP;
+      args[strcspn(args, " \t\n")] = '\0';
+      event->path = strdup(args);
+      error = args[0] == '\0' || event->path == NULL;
+    }
+    else
+      error = 1;
+    if (error) {
+      fprintf(stderr, "host: %s:%d: invalid %s event\n", path, line_no, type);
+      fclose(file);
+      return 1;
+    }
+    num_events++;
+  }
+  fclose(file);
+  return 0;
+}
+
+/**
+ * @brief Gets the tick of the last event
+ */
+
+uint32_t host_script_end() {
+  return num_events > 0 ? events[num_events - 1].tick : 0;
+}
+
+/**
+ * @brief Returns the events of a tick, one per call
+ *
+ * @param tick The current tick
+ * @return The next event due by this tick, or NULL
+ */
+
+const HostEvent *host_next_event(uint32_t tick) {
+  if (next_event == num_events || events[next_event].tick > tick)
+    return NULL;
+  return &events[next_event++];
+}
+
+/**
+ * @brief Frees the script
+ */
+
+void host_free_script() {
+  for (int i = 0; i < num_events; i++)
+    free(events[i].path);
+  num_events = 0;
+  next_event = 0;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file host_xpm.c
+ * @brief xpm_load() for the host build
+ *
+ * Decodes the XPMs of the game the way tools/xpm_bake does: colours are given
+ * as "#rrggbb" or "None", with 1 to 3 chars per pixel. Only XPM_8_8_8 output is
+ * supported, which is all the game asks for.
+ */
+
+#include "host.h"
+
+#define XPM_CHARS 95 /**< Printable characters usable in XPM pixels */
+#define MAX_CPP 3    /**< Every asset uses 1 to 3 chars per pixel */
+#define TRANSPARENT 0xFFFFFFFF
+
+/**
+ * @brief Computes the colour table index of a pixel made of cpp chars
+ */
+
+static int pixel_key(const char *chars, int cpp) {
+  int key = 0;
+  for (int i = 0; i < cpp; i++)
+    key = key * XPM_CHARS + (unsigned char) (chars[i] - ' ') % XPM_CHARS;
+  return key;
+}
+
+uint8_t *(xpm_load)(xpm_map_t map, enum xpm_image_type type, xpm_image_t *img) {
+  int width, height, num_colors, cpp;
+  if (type != XPM_8_8_8 || sscanf(map[0], "%d %d %d %d", &width, &height, &num_colors, &cpp) != 4 ||
+      cpp < 1 || cpp > MAX_CPP || width <= 0 || height <= 0)
+    return NULL;
+
+  int table_size = 1;
+  for (int i = 0; i < cpp; i++)
+    table_size *= XPM_CHARS;
+  uint32_t *table = malloc(table_size * sizeof(uint32_t));
+  uint8_t *pixels = malloc((size_t) width * height * 3);
+  if (table == NULL || pixels == NULL) {
+    free(table);
+    free(pixels);
+    return NULL;
+  }
+  for (int i = 0; i < table_size; i++)
+    table[i] = TRANSPARENT;
+  for (int i = 0; i < num_colors; i++) {
+    const char *row = map[1 + i];
+    const char *spec = strstr(row + cpp, "c ");
+    if (spec == NULL)
+      continue;
+    spec += 2;
+    while (*spec == ' ' || *spec == '\t')
+      spec++;
+    if (*spec == '#')
+      table[pixel_key(row, cpp)] = strtoul(spec + 1, NULL, 16) & 0xFFFFFF;
+  }
+
+  for (int i = 0; i < height; i++) {
+    const char *row = map[1 + num_colors + i];
+    for (int j = 0; j < width; j++) {
+      uint32_t color = table[pixel_key(row + j * cpp, cpp)];
+      uint8_t *pixel = pixels + ((size_t) i * width + j) * 3;
+      if (color == TRANSPARENT)
+        color = CHROMA_KEY_GREEN_888;
+      pixel[0] = color & 0xFF;
+      pixel[1] = (color >> 8) & 0xFF;
+      pixel[2] = (color >> 16) & 0xFF;
+    }
+  }
+  free(table);
+
+  img->type = XPM_8_8_8;
+  img->width = width;
+  img->height = height;
+  img->size = (size_t) width * height * 3;
+  img->bytes = pixels;
+  return pixels;
+}
+
+uint32_t(xpm_transparency_color)(enum xpm_image_type type) {
+  switch (type) {
+    case XPM_1_5_5_5:
+    case XPM_GRAY_1_5_5_5:
+      return TRANSPARENCY_COLOR_1_5_5_5;
+    case XPM_5_6_5:
+    case XPM_GRAY_5_6_5:
+      return CHROMA_KEY_GREEN_565;
+    case XPM_8_8_8:
+    case XPM_GRAY_8_8_8:
+      return CHROMA_KEY_GREEN_888;
+    case XPM_8_8_8_8:
+    case XPM_GRAY_8_8_8_8:
+      return TRANSPARENCY_COLOR_8_8_8_8;
+    default:
+      return 0;
+  }
+}
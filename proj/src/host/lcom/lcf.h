@@ -0,0 +1,78 @@
+#pragma once
+
+/* Linux replacement for <lcom/lcf.h>, used by the headless host build
+ * (see ../host.h). It declares the MINIX calls and LCF functions the game
+ * uses; the LCF lab headers themselves are shared with the MINIX build. */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include <minix/type.h>
+
+#include "../../../../.minix-src/include/lcom/lab2.h"
+#include "../../../../.minix-src/include/lcom/lab3.h"
+#include "../../../../.minix-src/include/lcom/lab4.h"
+#include "../../../../.minix-src/include/lcom/xpm.h"
+/* vbe.h ends its packed struct with the clang only "options align" pragma,
+ * the packing is reset here instead */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#include "../../../../.minix-src/include/lcom/vbe.h"
+#pragma GCC diagnostic pop
+#pragma pack()
+#include "../../../../.minix-src/include/lcom/video_gr.h"
+#include "../../../../.minix-src/include/lcom/proj.h"
+
+/* <sys/errno.h>, <minix/endpoint.h> and <minix/com.h> */
+#define OK 0
+#define ANY ((endpoint_t) 0x7ffe)
+#define SELF ((endpoint_t) 0x7ffc)
+#define HARDWARE ((endpoint_t) -2)
+#define _ENDPOINT_P(e) ((endpoint_t) (e))
+#define is_ipc_notify(ipc_status) ((ipc_status) == 1)
+#define IRQ_REENABLE 0x001
+#define IRQ_EXCLUSIVE 0x002
+#define SYS_PRIV_ADD_MEM 6
+
+/* Only the fields the game reads of a notification */
+typedef struct {
+  endpoint_t m_source;
+  struct {
+    uint32_t interrupts;
+  } m_notify;
+} message;
+
+/* The registers of <machine/int86.h>, without the 8 and 16 bit aliasing */
+typedef struct {
+  uint32_t eax, ebx, ecx, edx, esi, edi;
+  uint16_t ax, bx, cx, dx, es, di;
+  uint8_t intno, al, ah, bl, bh, cl, ch, dl, dh;
+} reg86_t;
+
+/* MINIX */
+int driver_receive(endpoint_t src, message *m_ptr, int *status_ptr);
+u32_t micros_to_ticks(u32_t micros);
+int sys_inb(int port, u32_t *value);
+int sys_outb(int port, u32_t value);
+int sys_int86(reg86_t *reg86p);
+int sys_irqsetpolicy(int irq_vec, int policy, int *irq_hook_id);
+int sys_irqrmpolicy(int *irq_hook_id);
+int sys_privctl(endpoint_t proc_ep, int req, void *p);
+int tickdelay(clock_t ticks);
+void *vm_map_phys(endpoint_t who, void *physaddr, size_t len);
+void panic(const char *fmt, ...);
+
+/* LCF */
+int lcf_start(int argc, char *argv[]);
+int lcf_cleanup(void);
+#define lcf_set_language(lang)
+#define lcf_trace_calls(syslog)
+#define lcf_log_output(output)
@@ -0,0 +1,5 @@
+#pragma once
+
+/* Linux replacement for <lcom/timer.h>, see lcf.h */
+
+#include "../../../../.minix-src/include/lcom/timer.h"
@@ -0,0 +1,22 @@
+#ifndef _HOST_MINIX_TYPE_H_
+#define _HOST_MINIX_TYPE_H_
+
+/* The few MINIX types used by the game and by the LCF headers, with the same
+ * definitions as <minix/type.h> */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+typedef uint8_t u8_t;
+typedef uint16_t u16_t;
+typedef uint32_t u32_t;
+typedef unsigned long phys_bytes; /* physical addr/length in bytes */
+typedef int endpoint_t;           /* process identifier */
+
+struct minix_mem_range {
+  phys_bytes mr_base;  /* Lowest memory address in range */
+  phys_bytes mr_limit; /* Highest memory address in range */
+};
+
+#endif
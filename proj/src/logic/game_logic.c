@@ -14,8 +14,25 @@
  */
 // check doc/collision-algorithm-visualisation.jpg
 bool sprite_collision(Sprite *sp1, Sprite *sp2) {
-  if (sp1->x < sp2->x + sp2->width && sp1->x + sp1->width > sp2->x &&
-      sp1->y < sp2->y + sp2->height && sp1->y + sp1->height > sp2->y) {
+  return area_collision(sp1->x, sp1->y, sp1->width, sp1->height, sp2->x, sp2->y, sp2->width, sp2->height);
+}
+
+/**
+ * @brief Checks for collision between two rectangles.
+ * 
+ * @param x1 X-coordinate of the first rectangle.
+ * @param y1 Y-coordinate of the first rectangle.
+ * @param w1 Width of the first rectangle.
+ * @param h1 Height of the first rectangle.
+ * @param x2 X-coordinate of the second rectangle.
+ * @param y2 Y-coordinate of the second rectangle.
+ * @param w2 Width of the second rectangle.
+ * @param h2 Height of the second rectangle.
+ * @return true if collision occurs, false otherwise.
+ */
+bool area_collision(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2) {
+  if (x1 < x2 + w2 && x1 + w1 > x2 &&
+      y1 < y2 + h2 && y1 + h1 > y2) {
     return true;
   }
   return false;
@@ -36,16 +53,7 @@ bool spawn_collision(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
         y < tank_sprite->y + tank_sprite->height && y + height + SPAWN_OFFSET > tank_sprite->y) {
     return true;
   }
-  y -= HEADER_HEIGHT;
-  for (uint16_t i = 0; i < height; i++) {
-    for (uint16_t j = 0; j < width; j++) {
-      if (!is_walkable(x + j, y + i)) {
-        return true; // Collision detected
-      }
-    }
-  }
-
-  return false;
+  return arena_area_blocked(x, y - HEADER_HEIGHT, width, height);
 }
 
 /**
@@ -59,18 +67,7 @@ bool spawn_collision(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
 bool move_collision(Sprite *sprite, int x_move, int y_move) {
   int x = sprite->x;
   int y = sprite->y - HEADER_HEIGHT;
-  int new_x = x + x_move;
-  int new_y = y + y_move;
-  uint16_t height = sprite->height;
-  uint16_t width = sprite->width;
-  for (uint16_t i = 0; i < height; i++) {
-    for (uint16_t j = 0; j < width; j++) {
-      if (!is_walkable(new_x + j, new_y + i)) {
-        return true; // Collision detected
-      }
-    }
-  }
-  return false; // No collision
+  return arena_area_blocked(x + x_move, y + y_move, sprite->width, sprite->height);
 }
 
 /**
@@ -82,45 +79,68 @@ bool move_collision(Sprite *sprite, int x_move, int y_move) {
  * @param collision Flag indicating whether collision should be checked.
  * @return 0 on success.
  */
-int(move_sprite_to)(Sprite *sp, uint16_t xf, uint16_t yf, bool collision) {
-  int16_t x_distance = xf - sp->x;
-  int16_t y_distance = yf - sp->y;
+int(move_sprite_to)(Sprite *sp, int xf, int yf, bool collision) {
+  return move_area_to(&sp->x, &sp->y, sp->width, sp->height, sp->xspeed, sp->yspeed, xf, yf, collision);
+}
+
+/**
+ * @brief Moves a rectangle to the specified coordinates while handling collision.
+ * 
+ * The rectangle moves at most xspeed and yspeed. If the arena blocks the
+ * move, moving along only one of the axes is tried.
+ * 
+ * @param x Pointer to the X-coordinate of the rectangle.
+ * @param y Pointer to the Y-coordinate of the rectangle.
+ * @param width Width of the rectangle.
+ * @param height Height of the rectangle.
+ * @param xspeed Horizontal speed.
+ * @param yspeed Vertical speed.
+ * @param xf Final X-coordinate.
+ * @param yf Final Y-coordinate.
+ * @param collision Flag indicating whether collision should be checked.
+ * @return 0 on success.
+ */
+int move_area_to(int16_t *x, int16_t *y, uint16_t width, uint16_t height, int xspeed, int yspeed,
+                 int xf, int yf, bool collision) {
+  int16_t x_distance = xf - *x;
+  int16_t y_distance = yf - *y;
   int16_t x_move = 0;
   int16_t y_move = 0;
   if (x_distance != 0) {
-    if (abs(x_distance) <= sp->xspeed) {
+    if (abs(x_distance) <= xspeed) {
       x_move = x_distance;
     }
     else {
       if (x_distance < 0)
-        x_move = -sp->xspeed;
+        x_move = -xspeed;
       else
-        x_move = sp->xspeed;
+        x_move = xspeed;
     }
   }
   if (y_distance != 0) {
-    if (abs(y_distance) <= sp->yspeed) {
+    if (abs(y_distance) <= yspeed) {
       y_move = y_distance;
     }
     else {
       if (y_distance < 0)
-        y_move = -sp->yspeed;
+        y_move = -yspeed;
       else
-        y_move = sp->yspeed;
+        y_move = yspeed;
     }
   }
   if (x_move != 0 || y_move != 0) {
     if (collision) {
-      if (!move_collision(sp, x_move, y_move)) {
-        sp->x += x_move;
-        sp->y += y_move;
+      int arena_y = *y - HEADER_HEIGHT;
+      if (!arena_area_blocked(*x + x_move, arena_y + y_move, width, height)) {
+        *x += x_move;
+        *y += y_move;
       }
-      else if(!move_collision(sp,x_move,0)) sp->x += x_move;
-      else if(!move_collision(sp,0,y_move)) sp->y += y_move;
+      else if(!arena_area_blocked(*x + x_move, arena_y, width, height)) *x += x_move;
+      else if(!arena_area_blocked(*x, arena_y + y_move, width, height)) *y += y_move;
     }
     else{
-      sp->x += x_move;
-      sp->y += y_move;
+      *x += x_move;
+      *y += y_move;
     }
   }
   return 0;
@@ -129,38 +149,60 @@ int(move_sprite_to)(Sprite *sp, uint16_t xf, uint16_t yf, bool collision) {
 /**
  * @brief Handles keyboard input for game controls.
  * 
+ * Only the pause acts on the scancode itself; the movement keys are read
+ * from the held key table by move_tank(), once a simulation step.
+ * 
  * @param bytes Array of keyboard input bytes.
  * @param size Size of the input array.
  */
 void handle_game_keyboard(uint8_t* bytes, uint8_t size) {
-  GameUnit* tank = get_tank_model();
-  uint8_t code;
-  int x = 0;
-  int y = 0;
-  if (size == 2) code = bytes[1];
-  else code = bytes[0];
-  switch(code){
-    case W_MAKE_CODE:
-      y = -10;
-      break;
-      case S_MAKE_CODE:
-      y = 10;
-      break;
-      case A_MAKE_CODE:
-      x = -10;
-      break;
-      case D_MAKE_CODE:
-      x = 10;
-      break;
-      case SPACEBAR_BREAK_CODE:
-      set_state(LOADING_PAUSE);
-      break;
-  }
-  if (!move_collision(tank->sprite.sp, x, y)) {
-    tank->sprite.sp->x += x;
-    tank->sprite.sp->y += y;
-    calculate_tank_direction();
+  if (size == 1 && bytes[0] == SPACEBAR_BREAK_CODE)
+    set_state(LOADING_PAUSE);
+}
+
+/**
+ * @brief Moves the tank by the movement keys down, for one simulation step.
+ * 
+ * W, A, S, D and the arrows may be combined into a diagonal, opposite keys
+ * cancel out. The tank moves TANK_STEP pixels along an axis, or
+ * TANK_DIAGONAL_STEP along both, whatever the typematic rate, with a single
+ * collision query; a blocked diagonal slides along the free axis instead.
+ * The position before the step is kept for draw_tank() to interpolate from.
+ */
+void move_tank() {
+  GameUnit *tank = get_tank_model();
+  Sprite *sp = tank->sp;
+  tank->prev_x = sp->x;
+  tank->prev_y = sp->y;
+  int x = 0, y = 0;
+  if (kbd_key_down(W_MAKE_CODE) || kbd_key_down(KEY_E0(ARROW_UP_MAKE_CODE)))
+    y--;
+  if (kbd_key_down(S_MAKE_CODE) || kbd_key_down(KEY_E0(ARROW_DOWN_MAKE_CODE)))
+    y++;
+  if (kbd_key_down(A_MAKE_CODE) || kbd_key_down(KEY_E0(ARROW_LEFT_MAKE_CODE)))
+    x--;
+  if (kbd_key_down(D_MAKE_CODE) || kbd_key_down(KEY_E0(ARROW_RIGHT_MAKE_CODE)))
+    x++;
+  kbd_clear_pressed();
+  if (x == 0 && y == 0)
+    return;
+
+  int step = (x != 0 && y != 0) ? TANK_DIAGONAL_STEP : TANK_STEP;
+  x *= step;
+  y *= step;
+  if (move_collision(sp, x, y)) {
+    if (x == 0 || y == 0)
+      return;
+    if (!move_collision(sp, x, 0))
+      y = 0;
+    else if (!move_collision(sp, 0, y))
+      x = 0;
+    else
+      return;
   }
+  sp->x += x;
+  sp->y += y;
+  calculate_tank_direction();
 }
 
 /**
@@ -193,8 +235,47 @@ int move_cursor(int16_t delta_x, int16_t delta_y) {
   return 0;
 }
 
+/**
+ * @brief Moves the crosshair towards the cursor by one simulation step and turns the tank to it.
+ */
+void update_crosshair() {
+  Sprite *crosshair = get_crosshair();
+  Sprite *cursor = get_cursor();
+  if ((crosshair->x != cursor->x) || (crosshair->y != cursor->y)) {
+    move_sprite_to(crosshair, cursor->x, cursor->y, false);
+    calculate_tank_direction();
+  }
+}
+
+/**
+ * @brief Turns the tank to a direction, unless the arena blocks it.
+ * 
+ * The tank takes the size of the pixmap of the new direction, which its
+ * collisions use until it turns again.
+ * 
+ * @param direction The direction to turn to.
+ * @return True if the tank turned, false if it would overlap the arena.
+ */
+static bool turn_tank(Direction direction) {
+  GameUnit *tank = get_tank_model();
+  const xpm_image_t *image = get_tank_image(direction);
+  uint16_t width = tank->sp->width, height = tank->sp->height;
+  tank->sp->width = image->width;
+  tank->sp->height = image->height;
+  if (arena_collision(tank->sp)) {
+    tank->sp->width = width;
+    tank->sp->height = height;
+    return false;
+  }
+  tank->direction = direction;
+  return true;
+}
+
 /**
  * @brief Calculates the direction of the tank based on the position of the crosshair.
+ * 
+ * Called by the simulation step when the tank or the crosshair moved. A turn
+ * the arena blocks is tried again on the next call.
  */
 void calculate_tank_direction() {
   static double prev_angle_deg = -1;
@@ -202,8 +283,8 @@ void calculate_tank_direction() {
   GameUnit *tank = get_tank_model();
   int crosshair_x = crosshair->x + (crosshair->width / 2);
   int crosshair_y = crosshair->y + (crosshair->height / 2);
-  int tank_x = tank->sprite.sp->x + (tank->sprite.sp->width / 2);
-  int tank_y = tank->sprite.sp->y + (tank->sprite.sp->height / 2);
+  int tank_x = tank->sp->x + (tank->sp->width / 2);
+  int tank_y = tank->sp->y + (tank->sp->height / 2);
   int x_diff = crosshair_x - tank_x;
   int y_diff = crosshair_y - tank_y;
   double angle_rad = atan2(y_diff, x_diff);
@@ -216,10 +297,10 @@ void calculate_tank_direction() {
     angle_deg -= 360.0;
   }
   if (prev_angle_deg < 0 || fabs(angle_deg - prev_angle_deg) > HYSTERESIS_THRESHOLD) {
-        uint8_t new_dir = (uint8_t)(angle_deg / 30.0);
-        tank->direction = new_dir;
-        prev_angle_deg = angle_deg;
-    }
+    Direction new_dir = (Direction) (angle_deg / 30.0);
+    if (turn_tank(new_dir))
+      prev_angle_deg = angle_deg;
+  }
 }
 
 /**
@@ -227,24 +308,14 @@ void calculate_tank_direction() {
  */
 void shoot() {
   Sprite *crosshair = get_crosshair();
-  Sprite *current_sprite;
   int crosshair_x = crosshair->x + 10;
   int crosshair_y = crosshair->y + 10;
   create_explosion(crosshair_x, crosshair_y);
   crosshair_x = crosshair->x + (crosshair->width / 2);
   crosshair_y = crosshair->y + (crosshair->height / 2);
-  Enemy *current = get_enemy_list();
-  while (current != NULL) {
-    if (current->model->type == STATIC_SPRITE)
-      current_sprite = current->model->sprite.sp;
-    else
-      current_sprite = current->model->sprite.asp->sp;
-    if (crosshair_x >= current_sprite->x && crosshair_x <= current_sprite->x + current_sprite->width &&
-        crosshair_y >= current_sprite->y && crosshair_y <= current_sprite->y + current_sprite->height) {
-      destroy_enemy(current);
-      increase_score();
-      return;
-    }
-    current = current->next;
+  int hit = find_enemy_at(crosshair_x, crosshair_y);
+  if (hit >= 0) {
+    destroy_enemy_at(hit);
+    increase_score();
   }
 }
@@ -6,19 +6,29 @@
 #include "../graphics/sprite.h"
 #include "../model/game_model.h"
 #include "../view/game_view.h"
+#include "../device/keyboard.h"
 
 bool sprite_collision(Sprite *sp1, Sprite *sp2);
 
+bool area_collision(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2);
+
 bool spawn_collision(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
 
 bool move_collision(Sprite *sprite, int x_move, int y_move);
 
-int(move_sprite_to)(Sprite *sp, uint16_t xf, uint16_t yf,bool collision);
+int(move_sprite_to)(Sprite *sp, int xf, int yf,bool collision);
+
+int move_area_to(int16_t *x, int16_t *y, uint16_t width, uint16_t height, int xspeed, int yspeed,
+                 int xf, int yf, bool collision);
 
 void handle_game_keyboard(uint8_t* bytes, uint8_t size);
 
+void move_tank();
+
 int move_cursor(int16_t delta_x,int16_t delta_y);
 
+void update_crosshair();
+
 void calculate_tank_direction();
 
 void shoot();
@@ -7,9 +7,13 @@
 
 
 /// @brief Static variables for the menu fonts.
-static xpm_image_t menu_font_selected, menu_font_unselected, menu_numbers, title_font;
-static uint8_t *menu_font_selected_ptr, *menu_font_unselected_ptr;
-static uint8_t *menu_numbers_ptr, *title_font_ptr;
+static Font menu_font_selected, menu_font_unselected, menu_numbers, title_font;
+
+/// @brief Menu whose static layer is in the menu buffer, NULL if none.
+static Menu *composed_menu = NULL;
+
+/// @brief Every menu, built once by load_menus().
+static Menu *menus[NUM_MENUS];
 
 /**
  * @brief Creates a new menu.
@@ -68,12 +72,14 @@ Menu *create_menu(Sprite *sp, char *title, int title_x, int title_y, char **opti
 }
 
 /**
- * @brief Frees the memory allocated for the menu.
+ * @brief Frees the memory allocated for the menu, including its sprite.
  *
  * @param menu Pointer to the menu to be freed.
  */
 
 void free_menu(Menu *menu) {
+  if (menu == composed_menu)
+    composed_menu = NULL;
   if (menu) {
     free(menu->title);
     for (int i = 0; i < menu->num_options; i++) {
@@ -87,19 +93,70 @@ void free_menu(Menu *menu) {
     free(menu->options_height);
     free(menu->options_width);
     free(menu->options_state);
+    destroy_sprite(menu->sp);
     free(menu);
   }
 }
 
+/**
+ * @brief Builds every menu.
+ *
+ * Each menu decodes its background once here, then stays loaded until
+ * free_menus(), so going from a menu to another only switches pointers.
+ *
+ * @return 0 on success, 1 if a menu could not be built.
+ */
+
+int load_menus() {
+  menus[MENU_INITIAL] = load_initial_menu();
+  menus[MENU_MAIN] = load_main_menu();
+  menus[MENU_HELP] = load_help_menu();
+  menus[MENU_HIGHSCORES] = load_highscores_menu();
+  menus[MENU_PAUSE] = load_pause_menu();
+  menus[MENU_GAME_OVER] = load_game_over_menu();
+  menus[MENU_NEW_HIGHSCORE] = load_new_highscore_menu();
+  for (int i = 0; i < NUM_MENUS; i++) {
+    if (menus[i] == NULL)
+      return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Frees every menu built by load_menus().
+ */
+
+void free_menus() {
+  for (int i = 0; i < NUM_MENUS; i++) {
+    free_menu(menus[i]);
+    menus[i] = NULL;
+  }
+}
+
+/**
+ * @brief Prepares a menu to be shown again.
+ *
+ * The first option is selected and the static layer of the menu is composed
+ * again when it is displayed, over whatever the arena buffer holds by then.
+ *
+ * @param menu Pointer to the menu.
+ */
+
+void reset_menu(Menu *menu) {
+  menu->selected_option = 0;
+  if (menu == composed_menu)
+    composed_menu = NULL;
+}
+
 /**
  * @brief Loads the fonts used in the menu.
  */
 
 void load_menu_fonts() {
-  menu_font_selected_ptr = xpm_load(menu_font_selected_xpm, XPM_8_8_8, &menu_font_selected);
-  menu_font_unselected_ptr = xpm_load(menu_font_unselected_xpm, XPM_8_8_8, &menu_font_unselected);
-  menu_numbers_ptr = xpm_load(menu_numbers_xpm, XPM_8_8_8, &menu_numbers);
-  title_font_ptr = xpm_load(title_font_xpm, XPM_8_8_8, &title_font);
+  load_font(&menu_font_selected, ASSET_MENU_FONT_SELECTED, LETTERS_NUM, MENU_FONT_WIDTH, MENU_FONT_HEIGHT, MENU_FONT_OFFSET);
+  load_font(&menu_font_unselected, ASSET_MENU_FONT_UNSELECTED, LETTERS_NUM, MENU_FONT_WIDTH, MENU_FONT_HEIGHT, MENU_FONT_OFFSET);
+  load_font(&menu_numbers, ASSET_MENU_NUMBERS, NUMBERS_NUM, MENU_FONT_WIDTH, MENU_FONT_HEIGHT, MENU_FONT_OFFSET);
+  load_font(&title_font, ASSET_TITLE_FONT, LETTERS_NUM, TITLE_FONT_WIDTH, TITLE_FONT_HEIGHT, TITLE_FONT_OFFSET);
 }
 
 /**
@@ -107,10 +164,10 @@ void load_menu_fonts() {
  */
 
 void free_menu_fonts() {
-  free(menu_font_selected_ptr);
-  free(menu_font_unselected_ptr);
-  free(menu_numbers_ptr);
-  free(title_font_ptr);
+  free_font(&menu_font_selected);
+  free_font(&menu_font_unselected);
+  free_font(&menu_numbers);
+  free_font(&title_font);
 }
 
 /**
@@ -127,9 +184,10 @@ Menu *load_initial_menu() {
   int options_height[1] = {78};
   int options_width[1] = {695};
   State options_state[1] = {LOADING_MAIN_MENU};
-  Menu *initial_menu = create_menu(create_sprite((const char **) initial_menu_xpm, 0, 0, 0, 0), "BYTE BATTLES", 130, 100, (char *[]){"PRESS SPACEBAR TO START"},
+  Menu *initial_menu = create_menu(create_sprite(ASSET_INITIAL_MENU, 0, 0, 0, 0), "BYTE BATTLES", 130, 100, (char *[]){"PRESS SPACEBAR TO START"},
                                    initial_menu_options_x, initial_menu_options_y, options_x_hitbox, options_y_hitbox, options_height, options_width, options_state, 1);
 
+  initial_menu->state = INITIAL_MENU;
   return initial_menu;
 }
 
@@ -147,8 +205,9 @@ Menu *load_main_menu() {
   int options_height[4] = {85, 85, 85, 85};
   int options_width[4] = {521, 521, 521, 521};
   State options_state[4] = {LOADING_GAME, LOADING_HELP, LOADING_HIGHSCORES, KILL};
-  Menu *main_menu = create_menu(create_sprite((const char **) main_menu_xpm, 0, 0, 0, 0), "MAIN MENU", 200, 100, (char *[]){"START GAME", "HELP", "HIGHSCORES", "EXIT"},
+  Menu *main_menu = create_menu(create_sprite(ASSET_MAIN_MENU, 0, 0, 0, 0), "MAIN MENU", 200, 100, (char *[]){"START GAME", "HELP", "HIGHSCORES", "EXIT"},
                                 main_menu_x, main_menu_y, options_x_hitbox, options_y_hitbox, options_height, options_width, options_state, 4);
+  main_menu->state = MAIN_MENU;
   return main_menu;
 }
 
@@ -166,8 +225,9 @@ Menu *load_help_menu() {
   int options_height[1] = {84};
   int options_width[1] = {521};
   State options_state[1] = {LOADING_MAIN_MENU};
-  Menu *help_menu = create_menu(create_sprite((const char **) help_menu_xpm, 0, 0, 0, 0), "HELP MENU", 200, 100, (char *[]){"MAIN MENU"},
+  Menu *help_menu = create_menu(create_sprite(ASSET_HELP_MENU, 0, 0, 0, 0), "HELP MENU", 200, 100, (char *[]){"MAIN MENU"},
                                 help_menu_x, help_menu_y, options_x_hitbox, options_y_hitbox, options_height, options_width, options_state, 1);
+  help_menu->state = HELP_MENU;
   return help_menu;
 }
 
@@ -185,8 +245,9 @@ Menu *load_highscores_menu() {
   int options_height[1] = {0};
   int options_width[1] = {0};
   State options_state[1] = {LOADING_MAIN_MENU};
-  Menu *highscores_menu = create_menu(create_sprite((const char **) highscores_menu_xpm, 0, 0, 0, 0), "HIGHSCORES", 200, 100, (char *[]){""},
+  Menu *highscores_menu = create_menu(create_sprite(ASSET_HIGHSCORES_MENU, 0, 0, 0, 0), "HIGHSCORES", 200, 100, (char *[]){""},
                                       highscores_menu_x, highscores_menu_y, options_x_hitbox, options_y_hitbox, options_height, options_width, options_state, 1);
+  highscores_menu->state = HIGHSCORES_MENU;
   return highscores_menu;
 }
 
@@ -204,8 +265,9 @@ Menu *load_pause_menu() {
   int options_height[3] = {85, 85, 85};
   int options_width[3] = {522, 522, 522};
   State options_state[3] = {INGAME, LOADING_MAIN_MENU, KILL};
-  Menu *pause_menu = create_menu(create_sprite((const char **) pause_menu_xpm, 0, 0, 0, 0), "GAME PAUSED", 200, 100, (char *[]){"RESUME", "MAIN MENU", "EXIT"},
+  Menu *pause_menu = create_menu(create_sprite(ASSET_PAUSE_MENU, 0, 0, 0, 0), "GAME PAUSED", 200, 100, (char *[]){"RESUME", "MAIN MENU", "EXIT"},
                                  pause_menu_x, pause_menu_y, options_x_hitbox, options_y_hitbox, options_height, options_width, options_state, 3);
+  pause_menu->state = PAUSE_MENU;
   return pause_menu;
 }
 
@@ -230,7 +292,7 @@ Menu *load_game_over_menu() {
   char *options[4] = {"SCORE", "PLAY AGAIN", "MAIN MENU", "EXIT"};
 
   Menu *game_over_menu = create_menu(
-    create_sprite((const char **) game_over_menu_xpm, 0, 0, 0, 0),
+    create_sprite(ASSET_GAME_OVER_MENU, 0, 0, 0, 0),
     "GAME OVER",
     200, 100,
     options,
@@ -243,6 +305,7 @@ Menu *load_game_over_menu() {
     options_state,
     num_options);
 
+  game_over_menu->state = GAME_OVER;
   return game_over_menu;
 }
 
@@ -260,134 +323,89 @@ Menu *load_new_highscore_menu() {
   int options_height[3] = {85, 85, 85};
   int options_width[3] = {522, 522, 522};
   State options_state[1] = {LOADING_MAIN_MENU};
-  Menu *new_highscore_menu = create_menu(create_sprite((const char **) new_highscore_menu_xpm, 0, 0, 0, 0), "NEW HIGHSCORE", 200, 100, (char *[]){"SUBMIT"},
+  Menu *new_highscore_menu = create_menu(create_sprite(ASSET_NEW_HIGHSCORE_MENU, 0, 0, 0, 0), "NEW HIGHSCORE", 200, 100, (char *[]){"SUBMIT"},
                                          new_highscore_menu_x, new_highscore_menu_y, options_x_hitbox, options_y_hitbox, options_height, options_width, options_state, 1);
+  new_highscore_menu->state = NEW_HIGHSCORE;
   return new_highscore_menu;
 }
 
 /**
  * @brief Displays the given menu on the screen.
  *
+ * The first time a menu is displayed, its background, title and options are
+ * composed in the menu buffer over what the arena buffer holds, and the
+ * double buffers are restored from there. Then each frame only draws the
+ * selected option over its unselected version.
+ *
  * @param menu Pointer to the menu to be displayed.
  */
 
 void display_menu(Menu *menu) {
-  draw_sprite(menu->sp);
-  draw_title(menu);
-  draw_options(menu);
+  if (menu != composed_menu) {
+    memcpy(get_menu_buffer(), get_arena_buffer(), H_RES * V_RES * VG_PIXEL_BYTES);
+    draw_sprite_to_buffer(menu->sp, get_menu_buffer());
+    draw_title(menu);
+    draw_options(menu);
+    composed_menu = menu;
+    vg_background_changed();
+  }
+  vg_set_background(get_menu_buffer());
+  draw_selected_option(menu);
 }
 
 /**
- * @brief Draws the title of the menu on the screen.
+ * @brief Draws the title of the menu into the menu buffer.
  *
  * @param menu Pointer to the menu whose title is to be drawn.
  */
 
 void draw_title(Menu *menu) {
-  draw_string(menu->title, menu->title_x, menu->title_y, TITLE_FONT_OFFSET, TITLE_FONT_HEIGHT, TITLE_FONT_WIDTH, title_font_ptr, title_font);
+  draw_string_to_buffer(menu->title, menu->title_x, menu->title_y, &title_font, get_menu_buffer());
 }
 
 /**
- * @brief Draws the options of the menu on the screen.
+ * @brief Draws the options of the menu, all unselected, into the menu buffer.
+ *
+ * The game over score and the help lines are drawn as well.
  *
  * @param menu Pointer to the menu whose options are to be drawn.
  */
 
 void draw_options(Menu *menu) {
+  char *buffer = get_menu_buffer();
   for (int i = 0; i < menu->num_options; i++) {
-    if (menu->selected_option == i)
-      draw_string(menu->options[i], menu->options_x[i], menu->options_y[i], MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_font_selected_ptr, menu_font_selected);
-
-    else {
-      draw_string(menu->options[i], menu->options_x[i], menu->options_y[i], MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_font_unselected_ptr, menu_font_unselected);
-    }
+    draw_string_to_buffer(menu->options[i], menu->options_x[i], menu->options_y[i], &menu_font_unselected, buffer);
   }
-  GameState state = get_game_state();
-  if (state.state == GAME_OVER) {
-    int score = state.score;
-    char *score_str = (char *) malloc(sizeof(char) * 20);
-    sprintf(score_str, "%d", score);
-    draw_string(score_str, 460, 210, MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_numbers_ptr, menu_numbers);
+  if (menu->state == GAME_OVER) {
+    char score_str[12];
+    snprintf(score_str, sizeof(score_str), "%u", get_score());
+    draw_string_to_buffer(score_str, 460, 210, &menu_numbers, buffer);
   }
-  if (state.state == HELP_MENU){
-    draw_string("W A S D", 100, 200, MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_font_selected_ptr, menu_font_selected);
-    draw_string("TO MOVE", 340, 200, MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_font_unselected_ptr, menu_font_unselected);
-    draw_string("MOVE MOUSE", 100, 250, MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_font_selected_ptr, menu_font_selected);
-    draw_string("TO AIM", 430, 250, MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_font_unselected_ptr, menu_font_unselected);
-    draw_string("LEFT CLICK", 100, 300, MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_font_selected_ptr, menu_font_selected);
-    draw_string("TO SHOOT", 430, 300, MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_font_unselected_ptr, menu_font_unselected);
-    draw_string("SPACEBAR", 100, 350, MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_font_selected_ptr, menu_font_selected);
-    draw_string("TO PAUSE", 370, 350, MENU_FONT_OFFSET, MENU_FONT_HEIGHT, MENU_FONT_WIDTH, menu_font_unselected_ptr, menu_font_unselected);
-  
+  if (menu->state == HELP_MENU){
+    draw_string_to_buffer("W A S D", 100, 200, &menu_font_selected, buffer);
+    draw_string_to_buffer("TO MOVE", 340, 200, &menu_font_unselected, buffer);
+    draw_string_to_buffer("MOVE MOUSE", 100, 250, &menu_font_selected, buffer);
+    draw_string_to_buffer("TO AIM", 430, 250, &menu_font_unselected, buffer);
+    draw_string_to_buffer("LEFT CLICK", 100, 300, &menu_font_selected, buffer);
+    draw_string_to_buffer("TO SHOOT", 430, 300, &menu_font_unselected, buffer);
+    draw_string_to_buffer("SPACEBAR", 100, 350, &menu_font_selected, buffer);
+    draw_string_to_buffer("TO PAUSE", 370, 350, &menu_font_unselected, buffer);
   }
 }
 
 /**
- * @brief Draws a single character on the screen.
+ * @brief Draws the selected option of the menu on the screen, if any.
  *
- * @param c The character to be drawn.
- * @param x The X coordinate of the character.
- * @param y The Y coordinate of the character.
- * @param font_offset The offset between characters in the font.
- * @param font_height The height of the character.
- * @param font_width The width of the character.
- * @param font_ptr Pointer to the font data.
- * @param font The font image.
- */
-
-void draw_character(char c, uint16_t x, uint16_t y, uint16_t font_offset, uint16_t font_height, uint16_t font_width, uint8_t *font_ptr, xpm_image_t font) {
-  char *buffer = get_drawing_buffer();
-  int char_pos;
-  if (c >= 'A' && c <= 'Z') {
-    char_pos = c - 'A';
-  }
-  else if (c >= '0' && c <= '9') {
-    char_pos = c - '0';
-  }
-  else {
-    return;
-  }
-  int xpm_width = font.width;
-  int char_offset = char_pos * (font_width + font_offset) * 3;
-  uint8_t *char_ptr = font_ptr + char_offset;
-  uint32_t color = 0;
-  uint32_t desl = 0;
-  int color_index;
-  for (int i = 0; i < font_height; i++) {
-    for (int j = 0; j < font_width; j++) {
-      desl = (i * xpm_width + j) * 3;
-      color = char_ptr[desl] | (char_ptr[desl + 1] << 8) | (char_ptr[desl + 2] << 16);
-
-      if (color != xpm_transparency_color(XPM_8_8_8)) {
-        color_index = (H_RES * (y + i) + (x + j)) * 3;
-        buffer[color_index] = color & 0xFF;
-        buffer[color_index + 1] = (color >> 8) & 0xFF;
-        buffer[color_index + 2] = (color >> 16) & 0xFF;
-      }
-    }
-  }
-}
-
-/**
- * @brief Draws a string on the screen.
+ * Both menu fonts have glyphs of the same shape, so the selected option
+ * covers its unselected version in the menu buffer exactly.
  *
- * @param str The string to be drawn.
- * @param x The X coordinate of the string.
- * @param y The Y coordinate of the string.
- * @param offset The offset between characters.
- * @param font_height The height of the characters.
- * @param font_width The width of the characters.
- * @param font_ptr Pointer to the font data.
- * @param font The font image.
+ * @param menu Pointer to the menu.
  */
 
-void draw_string(char *str, int x, int y, int offset, uint16_t font_height, uint16_t font_width, uint8_t *font_ptr, xpm_image_t font) {
-  int current_x = x;
-  while (*str) {
-    draw_character(*str, current_x, y, offset, font_height, font_width, font_ptr, font);
-    current_x += font_width + offset;
-    str++;
-  }
+void draw_selected_option(Menu *menu) {
+  int i = menu->selected_option;
+  if (i >= 0 && i < menu->num_options)
+    draw_string(menu->options[i], menu->options_x[i], menu->options_y[i], &menu_font_selected);
 }
 
 /**
@@ -465,79 +483,72 @@ void handle_menu_keyboard(Menu *menu, uint8_t *bytes, uint8_t size) {
 
 
 /**
- * @brief Gets the initial menu.
+ * @brief Gets the initial menu, built by load_menus().
  *
  * @return Pointer to the initial menu.
  */
 
 Menu *get_initial_menu() {
-  Menu *initial_menu = load_initial_menu();
-  return initial_menu;
+  return menus[MENU_INITIAL];
 }
 
 /**
- * @brief Gets the main menu.
+ * @brief Gets the main menu, built by load_menus().
  *
  * @return Pointer to the main menu.
  */
 
 Menu *get_main_menu() {
-  Menu *main_menu = load_main_menu();
-  return main_menu;
+  return menus[MENU_MAIN];
 }
 
 
 /**
- * @brief Gets the help menu.
+ * @brief Gets the help menu, built by load_menus().
  *
  * @return Pointer to the help menu.
  */
 
 Menu *get_help_menu() {
-  Menu *help_menu = load_help_menu();
-  return help_menu;
+  return menus[MENU_HELP];
 }
 
 /**
- * @brief Gets the highscores menu.
+ * @brief Gets the highscores menu, built by load_menus().
  *
  * @return Pointer to the highscores menu.
  */
 
 Menu *get_highscores_menu() {
-  Menu *highscores_menu = load_highscores_menu();
-  return highscores_menu;
+  return menus[MENU_HIGHSCORES];
 }
 
 /**
- * @brief Gets the pause menu.
+ * @brief Gets the pause menu, built by load_menus().
  *
  * @return Pointer to the pause menu.
  */
 
 Menu *get_pause_menu() {
-  Menu *pause_menu = load_pause_menu();
-  return pause_menu;
+  return menus[MENU_PAUSE];
 }
 
 /**
- * @brief Gets the game over menu.
+ * @brief Gets the game over menu, built by load_menus().
  *
  * @return Pointer to the game over menu.
  */
 
 Menu *get_game_over_menu() {
-  Menu *game_over_menu = load_game_over_menu();
-  return game_over_menu;
+  return menus[MENU_GAME_OVER];
 }
 
 /**
- * @brief Gets the new highscore menu.
+ * @brief Gets the new highscore menu, built by load_menus().
  *
  * @return Pointer to the new highscore menu.
  */
 
 Menu *get_new_highscore_menu() {
-  Menu *new_highscore_menu = load_new_highscore_menu();
-  return new_highscore_menu;
+  return menus[MENU_NEW_HIGHSCORE];
 }
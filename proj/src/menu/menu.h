@@ -4,19 +4,9 @@
 #include <lcom/lcf.h>
 #include "../view/game_view.h"
 #include "../graphics/sprite.h"
+#include "../graphics/font.h"
 #include "../dispatcher/state.h"
 #include "../device/i8042.h"
-#include "../../assets/xpm/menus/initial_menu.xpm"
-#include "../../assets/xpm/menus/main_menu.xpm"
-#include "../../assets/xpm/menus/highscores_menu.xpm"
-#include "../../assets/xpm/menus/help_menu.xpm"
-#include "../../assets/xpm/menus/pause_menu.xpm"
-#include "../../assets/xpm/menus/game_over_menu.xpm"
-#include "../../assets/xpm/menus/new_highscore_menu.xpm"
-#include "../../assets/xpm/text/menu_font_selected.xpm"
-#include "../../assets/xpm/text/menu_font_unselected.xpm"
-#include "../../assets/xpm/text/menu_numbers.xpm"
-#include "../../assets/xpm/text/title_font.xpm"
 
 typedef struct{
   Sprite *sp;
@@ -33,14 +23,33 @@ typedef struct{
   int *options_width;
   int selected_option;
   State *options_state;
+  State state;   ///< state the menu is shown in
 } Menu;
 
+/** Every menu, as built by load_menus() */
+typedef enum {
+  MENU_INITIAL,
+  MENU_MAIN,
+  MENU_HELP,
+  MENU_HIGHSCORES,
+  MENU_PAUSE,
+  MENU_GAME_OVER,
+  MENU_NEW_HIGHSCORE,
+  NUM_MENUS
+} MenuId;
+
 
 Menu *create_menu(Sprite *sp, char *title, int title_x, int title_y, char **options, int *options_x, int *options_y, int *options_x_hitbox,
  int *options_y_hitbox, int* options_height, int* options_width,State *options_state, int num_options);
 
 void free_menu(Menu *menu);
 
+int load_menus();
+
+void free_menus();
+
+void reset_menu(Menu *menu);
+
 void load_menu_fonts();
 
 void free_menu_fonts();
@@ -66,10 +75,7 @@ void draw_title(Menu *menu);
 
 void draw_options(Menu *menu);
 
-void draw_character(char c, uint16_t x, uint16_t y, uint16_t font_offset, uint16_t font_height,
-                 uint16_t font_width, uint8_t* font_ptr, xpm_image_t font);
-
-void draw_string(char* str, int x, int y, int offset, uint16_t font_height, uint16_t font_width, uint8_t *font_ptr, xpm_image_t font);    
+void draw_selected_option(Menu *menu);
 
 void handle_menu_click(Menu *menu);
 
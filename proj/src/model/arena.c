@@ -4,58 +4,360 @@
  */
 
 #include "arena.h"
+#include <sys/param.h>
 
 /// @brief Pointer to the current arena.
 static Arena *current_arena;
 
 /**
- * @brief Creates a new arena.
+ * @brief Tells whether a pixel of the collision map is blocked.
+ */
+
+static bool is_blocked(const Arena *arena, int x, int y) {
+  return arena->blocked[y][x / 32] & BIT(x % 32);
+}
+
+/**
+ * @brief Computes the clearance field of an arena.
  *
- * @param xpm The XPM map representing the arena layout.
- * @param ground_color The color representing the walkable ground in the arena.
- * @return Pointer to the newly created arena, or NULL if memory allocation fails.
+ * The Chebyshev distance from every pixel to the nearest blocked pixel is
+ * found with two chamfer passes, anything outside the arena counting as
+ * blocked. Each cell then keeps the smallest distance of its pixels, so a
+ * square of side 2 * clearance - 1 centered on any pixel of the cell is free.
+ * If the temporary buffer cannot be allocated every cell gets 0, which only
+ * disables the fast path of arena_area_blocked().
+ *
+ * @param arena The arena whose collision map is already built.
  */
 
-Arena *create_arena(xpm_map_t xpm, uint32_t ground_color) {
+static void build_clearance(Arena *arena) {
+  memset(arena->clearance, 0, sizeof(arena->clearance));
+  uint8_t (*dist)[ARENA_WIDTH] = malloc(sizeof(uint8_t[ARENA_HEIGHT][ARENA_WIDTH]));
+  if (dist == NULL)
+    return;
+
+  for (int i = 0; i < ARENA_HEIGHT; i++) {
+    for (int j = 0; j < ARENA_WIDTH; j++) {
+      int d = is_blocked(arena, j, i) ? 0 : UINT8_MAX;
+      int up = i > 0 ? dist[i - 1][j] : 0;
+      int left = j > 0 ? dist[i][j - 1] : 0;
+      int up_left = i > 0 && j > 0 ? dist[i - 1][j - 1] : 0;
+      int up_right = i > 0 && j < ARENA_WIDTH - 1 ? dist[i - 1][j + 1] : 0;
+      d = MIN(d, MIN(MIN(up, left), MIN(up_left, up_right)) + 1);
+      dist[i][j] = d;
+    }
+  }
+  for (int i = ARENA_HEIGHT - 1; i >= 0; i--) {
+    for (int j = ARENA_WIDTH - 1; j >= 0; j--) {
+      int down = i < ARENA_HEIGHT - 1 ? dist[i + 1][j] : 0;
+      int right = j < ARENA_WIDTH - 1 ? dist[i][j + 1] : 0;
+      int down_right = i < ARENA_HEIGHT - 1 && j < ARENA_WIDTH - 1 ? dist[i + 1][j + 1] : 0;
+      int down_left = i < ARENA_HEIGHT - 1 && j > 0 ? dist[i + 1][j - 1] : 0;
+      int d = MIN(MIN(down, right), MIN(down_right, down_left)) + 1;
+      if (d < dist[i][j])
+        dist[i][j] = d;
+    }
+  }
+
+  for (int i = 0; i < ARENA_HEIGHT / CLEARANCE_CELL; i++) {
+    for (int j = 0; j < ARENA_WIDTH / CLEARANCE_CELL; j++) {
+      uint8_t min = UINT8_MAX;
+      for (int k = 0; k < CLEARANCE_CELL; k++)
+        for (int l = 0; l < CLEARANCE_CELL; l++)
+          min = MIN(min, dist[i * CLEARANCE_CELL + k][j * CLEARANCE_CELL + l]);
+      arena->clearance[i][j] = min;
+    }
+  }
+  free(dist);
+}
+
+/**
+ * @brief Checks if any pixel of a rectangle of an arena is not walkable.
+ *
+ * The clearance of the cell holding the center of the rectangle answers most
+ * queries at once. Otherwise each row of the rectangle is tested against the
+ * collision map a 32 bit word at a time.
+ *
+ * @param arena The arena.
+ * @param x The X coordinate of the rectangle.
+ * @param y The Y coordinate of the rectangle.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @return True if the rectangle overlaps an obstacle or leaves the arena.
+ */
+
+static bool area_blocked(const Arena *arena, int x, int y, int width, int height) {
+  if (width <= 0 || height <= 0)
+    return false;
+  if (x < 0 || y < 0 || x + width > ARENA_WIDTH || y + height > ARENA_HEIGHT)
+    return true; // Out of bounds
+
+  int half = (MAX(width, height) + 1) / 2;
+  if (arena->clearance[(y + height / 2) / CLEARANCE_CELL][(x + width / 2) / CLEARANCE_CELL] > half)
+    return false;
+
+  int first_word = x / 32, last_word = (x + width - 1) / 32;
+  uint32_t first_mask = UINT32_MAX << (x % 32);
+  uint32_t last_mask = UINT32_MAX >> (31 - (x + width - 1) % 32);
+  for (int i = y; i < y + height; i++) {
+    const uint32_t *row = arena->blocked[i];
+    if (first_word == last_word) {
+      if (row[first_word] & first_mask & last_mask)
+        return true;
+      continue;
+    }
+    if (row[first_word] & first_mask)
+      return true;
+    for (int w = first_word + 1; w < last_word; w++)
+      if (row[w])
+        return true;
+    if (row[last_word] & last_mask)
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Builds the navigation grid of an arena.
+ *
+ * A cell is passable if the largest enemy, centered in it, is clear of the
+ * obstacles.
+ *
+ * @param arena The arena whose collision map is already built.
+ */
+
+static void build_nav_grid(Arena *arena) {
+  for (int i = 0; i < NAV_ROWS; i++) {
+    for (int j = 0; j < NAV_COLS; j++) {
+      int x = j * NAV_CELL + NAV_CELL / 2 - NAV_AGENT_SIZE / 2;
+      int y = i * NAV_CELL + NAV_CELL / 2 - NAV_AGENT_SIZE / 2;
+      arena->nav[i][j] = !area_blocked(arena, x, y, NAV_AGENT_SIZE, NAV_AGENT_SIZE);
+    }
+  }
+}
+
+/**
+ * @brief Hashes a decoded pixmap
+ *
+ * 32 bit FNV-1a over the pixmap read a 32 bit word at a time, enough to tell
+ * that an asset changed since its collision cache was written.
+ *
+ * @param map The pixmap
+ * @param size Its size in bytes
+ * @return The hash
+ */
+
+static uint32_t hash_pixmap(const uint8_t *map, size_t size) {
+  uint32_t hash = 2166136261u;
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    hash ^= map[i] | (map[i + 1] << 8) | (map[i + 2] << 16) | ((uint32_t) map[i + 3] << 24);
+    hash *= 16777619u;
+  }
+  for (; i < size; i++) {
+    hash ^= map[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * @brief Writes a 16 bit little endian value
+ */
+static void put16(uint8_t *p, uint16_t value) {
+  p[0] = value & 0xFF;
+  p[1] = value >> 8;
+}
+
+/**
+ * @brief Writes a 32 bit little endian value
+ */
+static void put32(uint8_t *p, uint32_t value) {
+  put16(p, value & 0xFFFF);
+  put16(p + 2, value >> 16);
+}
+
+/**
+ * @brief Fills the header of the collision cache of an arena
+ *
+ * @param header The header to fill, COLLISION_HEADER_SIZE bytes
+ * @param ground_color The walkable colour of the arena
+ * @param hash The hash of the decoded arena pixmap
+ */
+
+static void make_collision_header(uint8_t *header, uint32_t ground_color, uint32_t hash) {
+  memcpy(header, COLLISION_MAGIC, 4);
+  put16(header + 4, COLLISION_VERSION);
+  put16(header + 6, ARENA_WIDTH);
+  put16(header + 8, ARENA_HEIGHT);
+  put16(header + 10, CLEARANCE_CELL);
+  put32(header + 12, ground_color);
+  put32(header + 16, hash);
+}
+
+/**
+ * @brief Gets the path of the collision cache of an arena
+ */
+static void collision_cache_path(char *path, size_t size, const char *name) {
+  snprintf(path, size, "%s/%s.col", BAKED_ASSETS_DIR, name);
+}
+
+/**
+ * @brief Loads the collision map and clearance field of an arena from its cache
+ *
+ * The cache is only used if its header matches the one the arena would be
+ * written with, so a changed pixmap, ground colour or layout rebuilds it.
+ *
+ * @param arena The arena, whose ground_color is set
+ * @param name The asset name of the arena
+ * @param hash The hash of the decoded arena pixmap
+ * @return true if the cache was loaded, false if it is missing or stale
+ */
+
+static bool load_collision_cache(Arena *arena, const char *name, uint32_t hash) {
+  char path[256];
+  uint8_t expected[COLLISION_HEADER_SIZE], header[COLLISION_HEADER_SIZE];
+  collision_cache_path(path, sizeof(path), name);
+  make_collision_header(expected, arena->ground_color, hash);
+
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+    return false;
+  bool loaded = fread(header, 1, COLLISION_HEADER_SIZE, file) == COLLISION_HEADER_SIZE &&
+                memcmp(header, expected, COLLISION_HEADER_SIZE) == 0 &&
+                fread(arena->blocked, 1, sizeof(arena->blocked), file) == sizeof(arena->blocked) &&
+                fread(arena->clearance, 1, sizeof(arena->clearance), file) == sizeof(arena->clearance);
+  fclose(file);
+  return loaded;
+}
+
+/**
+ * @brief Writes the collision map and clearance field of an arena to its cache
+ *
+ * Failing to write it (e.g. a read only assets directory) is not an error,
+ * the next game start just builds them again. A file cut short is rejected
+ * when it is loaded.
+ *
+ * @param arena The arena, with its collision data built
+ * @param name The asset name of the arena
+ * @param hash The hash of the decoded arena pixmap
+ */
+
+static void save_collision_cache(const Arena *arena, const char *name, uint32_t hash) {
+  char path[256];
+  uint8_t header[COLLISION_HEADER_SIZE];
+  collision_cache_path(path, sizeof(path), name);
+  make_collision_header(header, arena->ground_color, hash);
+
+  FILE *file = fopen(path, "wb");
+  if (file == NULL)
+    return;
+  fwrite(header, 1, COLLISION_HEADER_SIZE, file);
+  fwrite(arena->blocked, 1, sizeof(arena->blocked), file);
+  fwrite(arena->clearance, 1, sizeof(arena->clearance), file);
+  fclose(file);
+}
+
+/**
+ * @brief Builds the collision map and clearance field of an arena
+ *
+ * @param arena The arena, whose ground_color is set
+ * @param map The decoded arena pixmap, in XPM_8_8_8
+ * @param width The width of the pixmap
+ * @param height The height of the pixmap
+ */
+
+static void build_collision(Arena *arena, const uint8_t *map, uint16_t width, uint16_t height) {
+  memset(arena->blocked, 0, sizeof(arena->blocked)); // 0 for walkable, 1 for obstacle
+  for (int i = 0; i < height && i < ARENA_HEIGHT; i++) {
+    for (int j = 0; j < width && j < ARENA_WIDTH; j++) {
+      uint32_t desl = (i * width + j) * 3;
+      uint32_t color = map[desl] | (map[desl + 1] << 8) | (map[desl + 2] << 16);
+      if (color != arena->ground_color) {
+        arena->blocked[i][j / 32] |= BIT(j % 32);  // obstacle found, mark it
+      }
+    }
+  }
+  // the first column and the rows up to HEADER_HEIGHT were never walkable
+  for (int i = 0; i < ARENA_HEIGHT; i++) {
+    arena->blocked[i][0] |= BIT(0);
+    if (i <= HEADER_HEIGHT)
+      memset(arena->blocked[i], 0xFF, sizeof(arena->blocked[i]));
+  }
+  build_clearance(arena);
+}
+
+/**
+ * @brief Builds an arena from its decoded pixmap, without drawing it
+ *
+ * The collision data derived from the pixmap comes from the cache next to
+ * the baked assets when that cache matches the pixmap, and is written there
+ * otherwise. The pixmap is kept by the caller, to draw with show_arena().
+ *
+ * @param map The decoded arena pixmap, in XPM_8_8_8
+ * @param img The image information of the pixmap
+ * @param name The asset name of the arena, used to find its collision cache
+ * @param ground_color The color representing the walkable ground in the arena
+ * @return Pointer to the new arena, or NULL if memory allocation fails
+ */
+
+Arena *build_arena(const uint8_t *map, const xpm_image_t *img, const char *name, uint32_t ground_color) {
   Arena *arena = (Arena *) malloc(sizeof(Arena));
   if (arena == NULL) {
     return NULL;
   }
 
   arena->ground_color = ground_color;
-
-  for (int i = 0; i < ARENA_HEIGHT; i++) {
-    for (int j = 0; j < ARENA_WIDTH; j++) {
-      arena->grid[i][j] = 0; // 0 for walkable, 1 for obstacle
-    }
+  uint32_t hash = hash_pixmap(map, img->size);
+  if (!load_collision_cache(arena, name, hash)) {
+    build_collision(arena, map, img->width, img->height);
+    save_collision_cache(arena, name, hash);
   }
+  build_nav_grid(arena);
+  return arena;
+}
 
-  xpm_image_t img;
-  unsigned char *map;
-  map = xpm_load(xpm, XPM_8_8_8, &img);
+/**
+ * @brief Makes an arena the current one and draws it into the arena buffer
+ *
+ * @param arena The arena, from build_arena()
+ * @param map The decoded arena pixmap it was built from
+ * @param img The image information of the pixmap
+ */
+
+void show_arena(Arena *arena, const uint8_t *map, const xpm_image_t *img) {
   char *buffer = get_arena_buffer();
-  uint32_t color;
-  uint32_t desl;
-  int color_index;
-  uint16_t height = img.height;
-  uint16_t width = img.width;
-  for (int i = 0; i < height; i++) {
-    for (int j = 0; j < width; j++) {
-      desl = (i * width + j) * 3;
-      color = map[desl] | (map[desl + 1] << 8) | (map[desl + 2] << 16);
-      if (color != ground_color) {
-        arena->grid[i][j] = 1;  // obstacle found, mark it
-      }
-      if (color != xpm_transparency_color(XPM_8_8_8)) {
-        color_index = (H_RES * (HEADER_HEIGHT + i) + j) * 3;
-        buffer[color_index] = color & 0xFF;
-        buffer[color_index + 1] = (color >> 8) & 0xFF;
-        buffer[color_index + 2] = (color >> 16) & 0xFF;
-      }
-    }
+  const BlitKernels *blit = blit_kernels();
+  for (int i = 0; i < img->height && i < ARENA_HEIGHT; i++) {
+    blit->copy_keyed(buffer + H_RES * (HEADER_HEIGHT + i) * VG_PIXEL_BYTES, map + i * img->width * 3,
+                     MIN(img->width, H_RES), xpm_transparency_color(XPM_8_8_8));
   }
-  free(map);
+  // the black header and footer bands are part of the background too
+  vg_fill_rect_to_buffer(buffer, 0, 0, H_RES, HEADER_HEIGHT, 0);
+  vg_fill_rect_to_buffer(buffer, 0, HEADER_HEIGHT + ARENA_HEIGHT, H_RES, FOOTER_HEIGHT, 0);
+  vg_background_changed();
   current_arena = arena;
+}
+
+/**
+ * @brief Creates a new arena.
+ *
+ * The pixmap is decoded, the arena built from it and drawn, all at once.
+ *
+ * @param asset The asset of the arena layout.
+ * @param ground_color The color representing the walkable ground in the arena.
+ * @return Pointer to the newly created arena, or NULL if memory allocation fails.
+ */
+
+Arena *create_arena(AssetId asset, uint32_t ground_color) {
+  xpm_image_t img;
+  uint8_t *map = load_asset(asset, &img);
+  if (map == NULL)
+    return NULL;
+  Arena *arena = build_arena(map, &img, asset_name(asset), ground_color);
+  if (arena != NULL)
+    show_arena(arena, map, &img);
+  free(map);
   return arena;
 }
 
@@ -69,10 +371,24 @@ Arena *create_arena(xpm_map_t xpm, uint32_t ground_color) {
 
 bool is_walkable(int x, int y) {
   Arena* arena = get_current_arena();
-  if (x <= 0 || x >= ARENA_WIDTH || y <= HEADER_HEIGHT || y >= (ARENA_HEIGHT + FOOTER_HEIGHT)) {
+  if (x < 0 || x >= ARENA_WIDTH || y < 0 || y >= ARENA_HEIGHT) {
     return false; // Out of bounds
   }
-  return !arena->grid[y][x];
+  return !is_blocked(arena, x, y);
+}
+
+/**
+ * @brief Checks if any pixel of a rectangle of the current arena is not walkable.
+ *
+ * @param x The X coordinate of the rectangle.
+ * @param y The Y coordinate of the rectangle.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @return True if the rectangle overlaps an obstacle or leaves the arena.
+ */
+
+bool arena_area_blocked(int x, int y, int width, int height) {
+  return area_blocked(get_current_arena(), x, y, width, height);
 }
 
 /**
@@ -83,18 +399,7 @@ bool is_walkable(int x, int y) {
  */
 
 bool arena_collision(Sprite *sprite) {
-  uint16_t x = sprite->x;
-  uint16_t y = sprite->y - HEADER_HEIGHT;
-  uint16_t height = sprite->height;
-  uint16_t width = sprite->width;
-  for (uint16_t i = 0; i < height; i++) {
-    for (uint16_t j = 0; j < width; j++) {
-      if (!is_walkable(x + j, y + i)) {
-        return true; // Collision detected
-      }
-    }
-  }
-  return false; // No collision
+  return arena_area_blocked(sprite->x, sprite->y - HEADER_HEIGHT, sprite->width, sprite->height);
 }
 
 /**
@@ -105,6 +410,8 @@ bool arena_collision(Sprite *sprite) {
 
 void destroy_arena(Arena *arena) {
   if (arena) {
+    if (arena == current_arena)
+      current_arena = NULL;
     free(arena);
   }
 }
@@ -3,18 +3,55 @@
 
 #include "../view/constants.h"
 #include "../graphics/video_gr.h"
+#include "../graphics/blit.h"
 #include "../graphics/sprite.h"
+#include "../graphics/baked.h"
+#include "../graphics/assets.h"
+
+#define ARENA_ROW_WORDS ((ARENA_WIDTH + 31) / 32) ///< 32 bit words per row of the collision map
+#define CLEARANCE_CELL 4                          ///< side of a cell of the clearance field, in pixels
+#define NAV_CELL 16                               ///< side of a cell of the navigation grid, in pixels
+#define NAV_COLS (ARENA_WIDTH / NAV_CELL)
+#define NAV_ROWS (ARENA_HEIGHT / NAV_CELL)
+#define NAV_AGENT_SIZE VIRUS2_WIDTH               ///< side of the largest enemy, which the grid is built for
+
+/*
+ * Collision cache, BAKED_ASSETS_DIR/<arena name>.col, written the first time
+ * an arena is created so later games skip deriving it from the pixmap.
+ *
+ * Layout (little endian):
+ *  - 0: magic "BBCM"
+ *  - 4: uint16 version
+ *  - 6: uint16 ARENA_WIDTH, 8: uint16 ARENA_HEIGHT
+ *  - 10: uint16 CLEARANCE_CELL
+ *  - 12: uint32 ground colour
+ *  - 16: uint32 FNV-1a hash of the decoded pixmap
+ *  - 20: the blocked bits of Arena, then its clearance field
+ *
+ * Bump COLLISION_VERSION whenever the way that data is derived changes.
+ */
+#define COLLISION_MAGIC "BBCM"
+#define COLLISION_VERSION 1
+#define COLLISION_HEADER_SIZE 20
 
 typedef struct {
-  int grid[ARENA_HEIGHT][ARENA_WIDTH];
+  uint32_t blocked[ARENA_HEIGHT][ARENA_ROW_WORDS]; ///< one bit per pixel, set if it is not walkable
+  uint8_t clearance[ARENA_HEIGHT / CLEARANCE_CELL][ARENA_WIDTH / CLEARANCE_CELL]; ///< distance from each cell to the nearest obstacle
+  uint8_t nav[NAV_ROWS][NAV_COLS]; ///< 1 if an enemy centered in the cell is clear of the obstacles
   uint32_t ground_color;
 
 } Arena;
 
-Arena* create_arena(xpm_map_t xpm, uint32_t ground_color);
+Arena* build_arena(const uint8_t *map, const xpm_image_t *img, const char *name, uint32_t ground_color);
+
+void show_arena(Arena *arena, const uint8_t *map, const xpm_image_t *img);
+
+Arena* create_arena(AssetId asset, uint32_t ground_color);
 
 bool is_walkable(int x, int y);
 
+bool arena_area_blocked(int x, int y, int width, int height);
+
 bool arena_collision(Sprite *sprite);
 
 void destroy_arena(Arena *arena);
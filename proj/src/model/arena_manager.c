@@ -0,0 +1,126 @@
+/**
+ * @file arena_manager.c
+ * @brief Implementation of the arena rotation and of its prefetching
+ */
+
+#include "arena_manager.h"
+
+/**
+ * @brief The arenas, in the order they are played
+ *
+ * arena1 is left out: its ground is shaded, not of a single colour, so most
+ * of it would be taken as obstacles.
+ */
+static const ArenaInfo arenas[] = {
+  {ASSET_ARENA3, 0x007B35, 500, 300},
+  {ASSET_ARENA4, 0x009BC4, 454, 300},
+  {ASSET_ARENA5, 0xFD7200, 476, 300},
+  {ASSET_ARENA2, 0x007B35, 500, 300},
+};
+
+#define NUM_ARENAS ((int) (sizeof(arenas) / sizeof(arenas[0])))
+
+/** @brief Index of the arena the next game starts in. */
+static int next_arena = 0;
+
+/** @brief An arena being prepared ahead of the game that uses it. */
+static struct {
+  int index;        ///< the arena, -1 if nothing is prefetched
+  uint8_t *map;     ///< its decoded pixmap, NULL until decoded
+  xpm_image_t img;  ///< the image information of the pixmap
+  Arena *arena;     ///< its collision data, NULL until built
+} prefetched = {-1, NULL, {0}, NULL};
+
+/**
+ * @brief Gets the number of arenas in the rotation
+ *
+ * @return The number of arenas
+ */
+
+int get_num_arenas() {
+  return NUM_ARENAS;
+}
+
+/**
+ * @brief Gets an arena of the rotation
+ *
+ * @param index The index of the arena, from 0 to get_num_arenas() - 1
+ * @return The arena, NULL if the index is out of range
+ */
+
+const ArenaInfo *get_arena_info(int index) {
+  if (index < 0 || index >= NUM_ARENAS)
+    return NULL;
+  return &arenas[index];
+}
+
+/**
+ * @brief Frees whatever was prefetched
+ */
+
+static void drop_prefetched() {
+  free(prefetched.map);
+  destroy_arena(prefetched.arena);
+  prefetched.index = -1;
+  prefetched.map = NULL;
+  prefetched.arena = NULL;
+}
+
+/**
+ * @brief Does the next step of preparing the arena of the next game
+ *
+ * Each call does at most one step, so a menu frame is only delayed by one of
+ * them: decoding the pixmap (a file read when it is baked), then building the
+ * collision data (a file read too once its cache was written). Whatever was
+ * prefetched for another arena is dropped first.
+ */
+
+void prefetch_next_arena() {
+  if (prefetched.index != next_arena) {
+    drop_prefetched();
+    prefetched.index = next_arena;
+  }
+  const ArenaInfo *info = &arenas[next_arena];
+  if (prefetched.map == NULL)
+    prefetched.map = load_asset(info->asset, &prefetched.img);
+  else if (prefetched.arena == NULL)
+    prefetched.arena = build_arena(prefetched.map, &prefetched.img, asset_name(info->asset), info->ground_color);
+}
+
+/**
+ * @brief Makes the arena of the next game the current one and draws it
+ *
+ * The steps not prefetched yet are done now. The arena of the last game is
+ * destroyed, if it was not when that game ended, and the pixmap is only kept
+ * until the new arena is drawn. The rotation then moves on, so the menus
+ * shown from now on prefetch the arena after this one.
+ *
+ * @return The entry of the arena, NULL if it could not be loaded
+ */
+
+const ArenaInfo *enter_next_arena() {
+  destroy_arena(get_current_arena());
+  prefetch_next_arena();
+  if (prefetched.map == NULL)
+    return NULL;
+  if (prefetched.arena == NULL)
+    prefetch_next_arena();
+  if (prefetched.arena == NULL)
+    return NULL;
+
+  const ArenaInfo *info = &arenas[next_arena];
+  show_arena(prefetched.arena, prefetched.map, &prefetched.img);
+  prefetched.arena = NULL;
+  drop_prefetched();
+  next_arena = (next_arena + 1) % NUM_ARENAS;
+  return info;
+}
+
+/**
+ * @brief Frees the current arena and whatever was prefetched
+ */
+
+void free_arenas() {
+  destroy_arena(get_current_arena());
+  drop_prefetched();
+}
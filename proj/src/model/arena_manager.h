@@ -0,0 +1,50 @@
+#ifndef _ARENA_MANAGER_H_
+#define _ARENA_MANAGER_H_
+
+#include <lcom/lcf.h>
+#include <stdint.h>
+#include "arena.h"
+
+/** @defgroup arena_manager Arena manager
+ * @{
+ *
+ * Every arena a game can be played in, used in turn: each game starts in the
+ * arena after the one the last game was played in. The next arena is decoded
+ * and built a step per tick while a menu is shown, so starting a game only
+ * draws it.
+ */
+
+/** An arena a game can be played in */
+typedef struct {
+  AssetId asset;         ///< its pixmap, whose name its collision cache is named after
+  uint32_t ground_color; ///< the colour of the walkable ground
+  uint16_t tank_x;       ///< where the tank starts, on the screen
+  uint16_t tank_y;
+} ArenaInfo;
+
+/** Gets the number of arenas in the rotation
+ */
+int get_num_arenas();
+
+/** Gets arena "index" of the rotation
+ */
+const ArenaInfo *get_arena_info(int index);
+
+/** Does the next step of preparing the arena the next game starts in,
+ *  if it is not ready yet. Called once per tick while a menu is shown.
+ */
+void prefetch_next_arena();
+
+/** Makes the arena of the next game the current one and draws it,
+ *  building it now if it was not prefetched, then moves the rotation on.
+ *  Returns the entry of the arena, NULL on failure
+ */
+const ArenaInfo *enter_next_arena();
+
+/** Frees the current arena and whatever was prefetched
+ */
+void free_arenas();
+
+/** @} end of arena_manager */
+
+#endif
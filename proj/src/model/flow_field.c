@@ -0,0 +1,119 @@
+/**
+ * @file flow_field.c
+ * @brief Implementation of the flow field leading the enemies to the tank.
+ */
+
+#include "flow_field.h"
+
+/** @brief Row and column steps to the 8 neighbours of a cell, the orthogonal ones first. */
+static const int8_t steps[8][2] = {
+  {-1, 0}, {1, 0}, {0, -1}, {0, 1}, {-1, -1}, {-1, 1}, {1, -1}, {1, 1},
+};
+
+/**
+ * @brief Computes the cell holding a point of the arena.
+ *
+ * @param x The X coordinate.
+ * @param y The Y coordinate.
+ * @return The index of the cell, FLOW_NONE if the point is outside the arena.
+ */
+
+static uint16_t cell_of(int x, int y) {
+  if (x < 0 || y < 0 || x >= NAV_COLS * NAV_CELL || y >= NAV_ROWS * NAV_CELL)
+    return FLOW_NONE;
+  return (y / NAV_CELL) * NAV_COLS + x / NAV_CELL;
+}
+
+/**
+ * @brief Marks the flow field as out of date.
+ *
+ * @param flow The flow field.
+ */
+
+void flow_invalidate(FlowField *flow) {
+  flow->arena = NULL;
+}
+
+/**
+ * @brief Searches the paths from every cell to the source.
+ *
+ * Moves go to the 8 neighbours, a diagonal one only if both cells beside it
+ * are passable so that paths do not cut the corners of obstacles. The first
+ * cell to reach another is its next cell, so the paths are among the
+ * shortest in moves.
+ *
+ * @param flow The flow field, whose arena and source are set.
+ */
+
+static void flow_search(FlowField *flow) {
+  const Arena *arena = flow->arena;
+  for (int i = 0; i < NAV_CELLS; i++)
+    flow->next[i] = FLOW_NONE;
+
+  // the source is never a next cell, so its own FLOW_NONE cannot mark it as unseen
+  uint16_t head = 0, tail = 0;
+  flow->queue[tail++] = flow->source;
+  while (head < tail) {
+    uint16_t cell = flow->queue[head++];
+    int row = cell / NAV_COLS, col = cell % NAV_COLS;
+    for (int k = 0; k < 8; k++) {
+      int r = row + steps[k][0], c = col + steps[k][1];
+      if (r < 0 || r >= NAV_ROWS || c < 0 || c >= NAV_COLS)
+        continue;
+      uint16_t neighbour = r * NAV_COLS + c;
+      if (neighbour == flow->source || flow->next[neighbour] != FLOW_NONE)
+        continue;
+      if (k >= 4 && (!arena->nav[row][c] || !arena->nav[r][col]))
+        continue;
+      flow->next[neighbour] = cell;
+      if (arena->nav[r][c])
+        flow->queue[tail++] = neighbour;
+    }
+  }
+}
+
+/**
+ * @brief Makes the paths lead to the cell holding a point.
+ *
+ * The search only runs when the point changed cell or the arena changed, so
+ * following the tank costs one search per cell it enters.
+ *
+ * @param flow The flow field.
+ * @param arena The arena.
+ * @param x The X coordinate of the point, in the arena.
+ * @param y The Y coordinate of the point, in the arena.
+ * @return true if the paths were searched again, false otherwise.
+ */
+
+bool flow_update(FlowField *flow, const Arena *arena, int x, int y) {
+  uint16_t source = cell_of(x, y);
+  if (source == FLOW_NONE || arena == NULL)
+    return false;
+  if (flow->arena == arena && flow->source == source)
+    return false;
+  flow->arena = arena;
+  flow->source = source;
+  flow_search(flow);
+  return true;
+}
+
+/**
+ * @brief Finds where to head for from a point to follow the paths.
+ *
+ * @param flow The flow field.
+ * @param x The X coordinate of the point, in the arena.
+ * @param y The Y coordinate of the point, in the arena.
+ * @param next_x Receives the X coordinate of the center of the next cell.
+ * @param next_y Receives the Y coordinate of the center of the next cell.
+ * @return true if there is a next cell, false otherwise.
+ */
+
+bool flow_next_point(const FlowField *flow, int x, int y, int *next_x, int *next_y) {
+  uint16_t cell = cell_of(x, y);
+  if (flow->arena == NULL || cell == FLOW_NONE || flow->next[cell] == FLOW_NONE)
+    return false;
+  uint16_t next = flow->next[cell];
+  *next_x = (next % NAV_COLS) * NAV_CELL + NAV_CELL / 2;
+  *next_y = (next / NAV_COLS) * NAV_CELL + NAV_CELL / 2;
+  return true;
+}
@@ -0,0 +1,40 @@
+#ifndef _FLOW_FIELD_H_
+#define _FLOW_FIELD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arena.h"
+
+#define NAV_CELLS (NAV_ROWS * NAV_COLS)
+#define FLOW_NONE UINT16_MAX ///< no next cell: the source itself, or a cell it cannot be reached from
+
+/** Paths from every cell of the navigation grid of an arena to one cell,
+ *  the source, found by a breadth first search from it. Each cell keeps the
+ *  next cell on its way to the source, so steering an enemy is one lookup.
+ *  Cells that are not passable are reached from their passable neighbours
+ *  but not crossed, so an enemy standing partly in one steers back out.
+ */
+typedef struct {
+  const Arena *arena;       ///< the arena, NULL if the field must be rebuilt
+  uint16_t source;          ///< the cell the paths lead to
+  uint16_t next[NAV_CELLS]; ///< next cell towards the source, FLOW_NONE if none
+  uint16_t queue[NAV_CELLS];
+} FlowField;
+
+/** Makes the next flow_update() rebuild the field, e.g. after the arena changed
+ */
+void flow_invalidate(FlowField *flow);
+
+/** Makes the paths lead to the cell holding point (x, y) of the arena,
+ *  searching again only if that cell is not the source already.
+ *  Returns true if the field was rebuilt
+ */
+bool flow_update(FlowField *flow, const Arena *arena, int x, int y);
+
+/** Finds the center of the next cell on the way from point (x, y) to the
+ *  source. Returns false, leaving next_x and next_y alone, if the point is
+ *  in the source cell, outside the arena or in a cell with no path
+ */
+bool flow_next_point(const FlowField *flow, int x, int y, int *next_x, int *next_y);
+
+#endif
@@ -4,12 +4,41 @@
  */
 
 #include "game_model.h"
+#include <sys/param.h>
 
 /// @brief Pointer to the tank game unit.
 static GameUnit *tank;
 
-/// @brief Pointer to the linked list of enemies.
-static Enemy *enemy_list = NULL;
+/// @brief Every enemy alive.
+static EnemyPool enemies;
+
+/// @brief Dense index + 1 of the enemy in each handle slot, 0 if the slot is free.
+static uint16_t slot_index[MAX_ENEMIES];
+
+/// @brief Generation of each handle slot, bumped when its enemy is destroyed.
+static uint16_t slot_generation[MAX_ENEMIES];
+
+/// @brief Slots released by destroyed enemies, and the first slot never used.
+static uint16_t free_slots[MAX_ENEMIES];
+static int num_free_slots = 0, next_slot = 0;
+
+/// @brief Where the enemies are, indexed by their handle slot.
+static SpatialGrid enemy_grid;
+
+_Static_assert(MAX_ENEMIES <= GRID_MAX_IDS, "every enemy slot must fit in the grid");
+
+/// @brief Paths from anywhere in the arena to the tank, followed by the enemies.
+static FlowField enemy_flow;
+
+/// @brief Size, speed and health of each enemy type.
+static const struct {
+  uint16_t width, height;
+  int8_t speed;
+  int16_t hp;
+} enemy_types[NUM_ENEMY_TYPES] = {
+  [VIRUS1] = {VIRUS1_WIDTH, VIRUS1_HEIGHT, 1, 1},
+  [VIRUS2] = {VIRUS2_WIDTH, VIRUS2_HEIGHT, 2, 2},
+};
 
 /**
  * @brief Creates the game elements.
@@ -20,6 +49,7 @@ static Enemy *enemy_list = NULL;
 int create_game_elements() {
   Sprite *tank_sprite = get_tank_sprite();
   tank = create_static_game_element(5, tank_sprite, DIRECTION_3);
+  flow_invalidate(&enemy_flow); // the game may be played in another arena
   return 0;
 }
 
@@ -35,123 +65,140 @@ int create_game_elements() {
 GameUnit *create_static_game_element(uint16_t hp, Sprite *sp, Direction direction) {
   GameUnit *element = malloc(sizeof(GameUnit));
   element->hp = hp;
-  element->sprite.sp = sp;
+  element->sp = sp;
   element->direction = direction;
-  element->type = STATIC_SPRITE;
+  element->prev_x = sp->x;
+  element->prev_y = sp->y;
   return element;
 }
 
 /**
- * @brief Creates an animated game element.
+ * @brief Creates an enemy.
  *
- * @param hp The health points of the element.
- * @param asp Pointer to the animated sprite of the element.
- * @param direction The direction of the element.
- * @return Pointer to the newly created game unit.
+ * The enemy is appended to the pool, no memory is allocated.
+ *
+ * @param enemy_type The type of the enemy.
+ * @param x The X coordinate of the enemy.
+ * @param y The Y coordinate of the enemy.
+ * @return Handle to the new enemy, invalid if the pool is full.
  */
 
-GameUnit *create_animated_game_element(uint16_t hp, AnimSprite *asp, Direction direction) {
-  GameUnit *element = malloc(sizeof(GameUnit));
-  element->hp = hp;
-  element->sprite.asp = asp;
-  element->direction = direction;
-  element->type = ANIMATED_SPRITE;
-  return element;
+EnemyHandle create_enemy(EnemyType enemy_type, int x, int y) {
+  EnemyHandle handle = {MAX_ENEMIES, 0};
+  if (enemy_type >= NUM_ENEMY_TYPES || enemies.count == MAX_ENEMIES) {
+    return handle;
+  }
+
+  handle.slot = num_free_slots > 0 ? free_slots[--num_free_slots] : next_slot++;
+  handle.generation = slot_generation[handle.slot];
+
+  int i = enemies.count++;
+  enemies.x[i] = x;
+  enemies.y[i] = y;
+  enemies.prev_x[i] = x;
+  enemies.prev_y[i] = y;
+  enemies.width[i] = enemy_types[enemy_type].width;
+  enemies.height[i] = enemy_types[enemy_type].height;
+  enemies.xspeed[i] = enemy_types[enemy_type].speed;
+  enemies.yspeed[i] = enemy_types[enemy_type].speed;
+  enemies.hp[i] = enemy_types[enemy_type].hp;
+  enemies.type[i] = enemy_type;
+  enemies.frame[i] = 0;
+  enemies.frame_ticks[i] = 0;
+  enemies.slot[i] = handle.slot;
+  slot_index[handle.slot] = i + 1;
+  grid_insert(&enemy_grid, handle.slot, x, y);
+
+  return handle;
 }
 
 /**
- * @brief Creates an enemy.
+ * @brief Finds where an enemy is stored in the pool.
  *
- * @param sprite Pointer to the sprite or animated sprite of the enemy.
- * @param direction The direction of the enemy.
- * @param x The X coordinate of the enemy.
- * @param y The Y coordinate of the enemy.
- * @param enemy_type The type of the enemy.
- * @return Pointer to the newly created enemy.
+ * @param handle Handle to the enemy.
+ * @return Index of the enemy in the pool, or -1 if it was destroyed.
  */
 
-Enemy *create_enemy(void *sprite, Direction direction, int x, int y, EnemyType enemy_type) {
-  GameUnit *enemy_model;
-  uint16_t hp;
-
-  if (enemy_type == VIRUS1) {
-    hp = 1;
-    enemy_model = create_static_game_element(hp, (Sprite *) sprite, direction);
-    enemy_model->sprite.sp->x = x;
-    enemy_model->sprite.sp->y = y;
-  }
-  else if (enemy_type == VIRUS2) {
-    hp = 2;
-    enemy_model = create_animated_game_element(hp, (AnimSprite *) sprite, direction);
-    AnimSprite *enemy_asprite = enemy_model->sprite.asp;
-    enemy_asprite->sp->x = x;
-    enemy_asprite->sp->y = y;
-  }
-  else {
-    return NULL;
+int get_enemy_index(EnemyHandle handle) {
+  if (handle.slot >= MAX_ENEMIES || slot_index[handle.slot] == 0 ||
+      slot_generation[handle.slot] != handle.generation) {
+    return -1;
   }
+  return slot_index[handle.slot] - 1;
+}
 
-  Enemy *new_enemy = malloc(sizeof(Enemy));
-  new_enemy->model = enemy_model;
-  new_enemy->enemy_type = enemy_type;
-  new_enemy->next = enemy_list;
-  enemy_list = new_enemy;
+/**
+ * @brief Gets a handle to the enemy stored at an index of the pool.
+ *
+ * @param index Index of the enemy in the pool.
+ * @return Handle to the enemy.
+ */
 
-  return new_enemy;
+EnemyHandle get_enemy_handle(int index) {
+  EnemyHandle handle = {enemies.slot[index], slot_generation[enemies.slot[index]]};
+  return handle;
 }
 
 /**
- * @brief Destroys a game element.
+ * @brief Destroys the enemy stored at an index of the pool.
  *
- * @param element Pointer to the game element to be destroyed.
- * @param type The type of the sprite.
+ * The last enemy is moved into its place, so when iterating over the pool
+ * the same index must be visited again.
+ *
+ * @param index Index of the enemy in the pool.
  */
 
-void destroy_game_element(GameUnit *element, SpriteType type) {
-  if (type == STATIC_SPRITE)
-    destroy_sprite(element->sprite.sp);
-  else if (type == ANIMATED_SPRITE)
-    destroy_asprite(element->sprite.asp);
-  free(element);
+void destroy_enemy_at(int index) {
+  uint16_t slot = enemies.slot[index];
+  int last = --enemies.count;
+  if (index != last) {
+    enemies.x[index] = enemies.x[last];
+    enemies.y[index] = enemies.y[last];
+    enemies.prev_x[index] = enemies.prev_x[last];
+    enemies.prev_y[index] = enemies.prev_y[last];
+    enemies.width[index] = enemies.width[last];
+    enemies.height[index] = enemies.height[last];
+    enemies.xspeed[index] = enemies.xspeed[last];
+    enemies.yspeed[index] = enemies.yspeed[last];
+    enemies.hp[index] = enemies.hp[last];
+    enemies.type[index] = enemies.type[last];
+    enemies.frame[index] = enemies.frame[last];
+    enemies.frame_ticks[index] = enemies.frame_ticks[last];
+    enemies.slot[index] = enemies.slot[last];
+    slot_index[enemies.slot[index]] = index + 1;
+  }
+  grid_remove(&enemy_grid, slot);
+  slot_index[slot] = 0;
+  slot_generation[slot]++;
+  free_slots[num_free_slots++] = slot;
 }
 
 /**
  * @brief Destroys an enemy.
  *
- * @param enemy Pointer to the enemy to be destroyed.
+ * Does nothing if the enemy was already destroyed.
+ *
+ * @param handle Handle to the enemy to be destroyed.
  */
 
-void destroy_enemy(Enemy *enemy) {
-  Enemy **current = &enemy_list;
-  while (*current != NULL) {
-    if (*current == enemy) {
-      Enemy *to_free = *current;
-      *current = (*current)->next;
-      destroy_game_element(to_free->model, to_free->model->type);
-      free(to_free);
-      return;
-    }
-    current = &((*current)->next);
+void destroy_enemy(EnemyHandle handle) {
+  int index = get_enemy_index(handle);
+  if (index >= 0) {
+    destroy_enemy_at(index);
   }
 }
 
 /**
  * @brief Frees all enemies.
+ *
+ * Every handle given so far becomes invalid.
  */
 
 void free_enemies() {
-  Enemy *current = enemy_list;
-  Enemy *next;
-
-  while (current != NULL) {
-    next = current->next;
-    destroy_game_element(current->model, current->model->type);
-    free(current);
-    current = next;
+  while (enemies.count > 0) {
+    destroy_enemy_at(enemies.count - 1);
   }
-
-  // Set the enemy_list to NULL after freeing all enemies
-  enemy_list = NULL;
+  grid_clear(&enemy_grid);
 }
 
 /**
@@ -171,20 +218,14 @@ void cleanup_elements() {
 
 void spawn_enemy(EnemyType enemy_type) {
   int x, y;
+  if (enemies.count == MAX_ENEMIES)
+    return;
   do {
     x = rand() % ARENA_WIDTH;
     y = (rand() % ARENA_HEIGHT);
-  } while (spawn_collision(x, y, VIRUS1_WIDTH, VIRUS1_HEIGHT));
-
-  if (enemy_type == VIRUS1) {
-    Sprite *new_sprite = create_virus1_sprite(x, y);
-    create_enemy(new_sprite, DIRECTION_1, x, y, enemy_type);
-  }
-  if (enemy_type == VIRUS2) {
-    AnimSprite *new_asprite = create_virus2_asprite(x, y);
-    create_enemy(new_asprite, DIRECTION_1, x, y, enemy_type);
-  }
+  } while (spawn_collision(x, y, enemy_types[enemy_type].width, enemy_types[enemy_type].height));
 
+  create_enemy(enemy_type, x, y);
 }
 
 /**
@@ -202,37 +243,120 @@ void spawn_enemy_wave() {
 }
 
 /**
- * @brief Updates the enemies.
+ * @brief Finds the enemy under a point.
+ *
+ * The borders of the enemies count as inside.
+ *
+ * @param x The X coordinate of the point.
+ * @param y The Y coordinate of the point.
+ * @return Index of the enemy in the pool, or -1 if there is none.
  */
 
-void update_enemies() {
-  Enemy *current = enemy_list;
-  uint16_t tank_x = tank->sprite.sp->x;
-  uint16_t tank_y = tank->sprite.sp->y;
-  Sprite *current_sprite;
-  while (current != NULL) {
-    if (current->model->type == STATIC_SPRITE) {
-      current_sprite = current->model->sprite.sp;
+int find_enemy_at(int x, int y) {
+  uint16_t slots[MAX_ENEMIES];
+  int num_slots = grid_query_point(&enemy_grid, x, y, slots, MAX_ENEMIES);
+  for (int k = 0; k < num_slots; k++) {
+    int i = slot_index[slots[k]] - 1;
+    if (x >= enemies.x[i] && x <= enemies.x[i] + enemies.width[i] &&
+        y >= enemies.y[i] && y <= enemies.y[i] + enemies.height[i]) {
+      return i;
     }
-    else {
-      current_sprite = current->model->sprite.asp->sp;
+  }
+  return -1;
+}
+
+/**
+ * @brief Finds the enemies overlapping a rectangle.
+ *
+ * @param x The X coordinate of the rectangle.
+ * @param y The Y coordinate of the rectangle.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @param handles Filled with handles to the enemies found.
+ * @param max_handles The capacity of handles.
+ * @return The number of enemies found.
+ */
+
+int find_enemies_in(int x, int y, int width, int height, EnemyHandle *handles, int max_handles) {
+  uint16_t slots[MAX_ENEMIES];
+  int num_slots = grid_query_rect(&enemy_grid, x, y, width, height, slots, MAX_ENEMIES);
+  int found = 0;
+  for (int k = 0; k < num_slots && found < max_handles; k++) {
+    int i = slot_index[slots[k]] - 1;
+    if (area_collision(enemies.x[i], enemies.y[i], enemies.width[i], enemies.height[i], x, y, width, height)) {
+      handles[found++] = get_enemy_handle(i);
     }
+  }
+  return found;
+}
 
-    move_sprite_to(current_sprite, tank_x, tank_y, true);
-    if (sprite_collision(current_sprite, tank->sprite.sp)) {
-      current->model->hp--;
-      if (current->model->hp <= 0) {
-        Enemy *to_destroy = current;
-        current = current->next;
-        destroy_enemy(to_destroy);
-      }
+/**
+ * @brief Finds where an enemy heads for.
+ *
+ * An enemy follows the flow field to the cell of the tank, then heads
+ * straight for the tank, as does one in a cell the field has no path from.
+ *
+ * @param i The index of the enemy in the pool.
+ * @param x The X coordinate of the tank, replaced by the one to head for.
+ * @param y The Y coordinate of the tank, replaced by the one to head for.
+ */
+
+static void steer_enemy(int i, int *x, int *y) {
+  int half_width = enemies.width[i] / 2, half_height = enemies.height[i] / 2;
+  int next_x, next_y;
+  if (flow_next_point(&enemy_flow, enemies.x[i] + half_width, enemies.y[i] - HEADER_HEIGHT + half_height,
+                      &next_x, &next_y)) {
+    *x = MAX(next_x - half_width, 0);
+    *y = MAX(next_y - half_height, 0) + HEADER_HEIGHT;
+  }
+}
+
+/**
+ * @brief Updates the enemies by one simulation step.
+ *
+ * Each enemy moves along the flow field towards the tank, which is only
+ * searched again when the tank enters another cell. The previous position
+ * of each enemy is kept so that frames drawn between two steps can
+ * interpolate it. Then only the enemies the grid finds
+ * around the tank are tested against it: an enemy touching the tank hurts it
+ * and loses health, and keeps moving and hitting until it dies or stops
+ * touching it.
+ */
+
+void update_enemies() {
+  Sprite *tank_sprite = tank->sp;
+  int tank_x = tank_sprite->x;
+  int tank_y = tank_sprite->y;
+  flow_update(&enemy_flow, get_current_arena(), tank_x + tank_sprite->width / 2,
+              tank_y - HEADER_HEIGHT + tank_sprite->height / 2);
+  for (int i = 0; i < enemies.count; i++) {
+    enemies.prev_x[i] = enemies.x[i];
+    enemies.prev_y[i] = enemies.y[i];
+    int target_x = tank_x, target_y = tank_y;
+    steer_enemy(i, &target_x, &target_y);
+    move_area_to(&enemies.x[i], &enemies.y[i], enemies.width[i], enemies.height[i],
+                 enemies.xspeed[i], enemies.yspeed[i], target_x, target_y, true);
+    grid_move(&enemy_grid, enemies.slot[i], enemies.x[i], enemies.y[i]);
+  }
+
+  EnemyHandle hits[MAX_ENEMIES];
+  int num_hits = find_enemies_in(tank_x, tank_y, tank_sprite->width, tank_sprite->height, hits, MAX_ENEMIES);
+  for (int k = 0; k < num_hits; k++) {
+    int i = get_enemy_index(hits[k]);
+    while (i >= 0 && area_collision(enemies.x[i], enemies.y[i], enemies.width[i], enemies.height[i],
+                                    tank_x, tank_y, tank_sprite->width, tank_sprite->height)) {
       tank->hp--;
       if (tank->hp <= 0) {
         set_state(GAME_END);
       }
-    }
-    else {
-      current = current->next;
+      enemies.hp[i]--;
+      if (enemies.hp[i] <= 0) {
+        destroy_enemy_at(i);
+        break;
+      }
+      move_area_to(&enemies.x[i], &enemies.y[i], enemies.width[i], enemies.height[i],
+                   enemies.xspeed[i], enemies.yspeed[i], tank_x, tank_y, true);
+      grid_move(&enemy_grid, enemies.slot[i], enemies.x[i], enemies.y[i]);
     }
   }
 }
@@ -248,11 +372,11 @@ GameUnit *get_tank_model() {
 }
 
 /**
- * @brief Gets the list of enemies.
+ * @brief Gets the pool of enemies.
  *
- * @return Pointer to the list of enemies.
+ * @return Pointer to the pool of enemies.
  */
 
-Enemy *get_enemy_list() {
-  return enemy_list;
+EnemyPool *get_enemy_pool() {
+  return &enemies;
 }
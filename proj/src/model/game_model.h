@@ -2,6 +2,8 @@
 #define _GAME_MODEL_H_
 
 #include "arena.h"
+#include "spatial_grid.h"
+#include "flow_field.h"
 #include "../graphics/sprite.h"
 #include "../view/game_view.h"
 #include "../view/constants.h"
@@ -11,43 +13,57 @@
 #include <math.h>
 #include <stdint.h>
 
-typedef enum {
-  STATIC_SPRITE,
-  ANIMATED_SPRITE
-} SpriteType;
-
 typedef struct {
   uint16_t hp;
-  SpriteType type;
-  union{
-    Sprite *sp;
-    AnimSprite *asp;
-  } sprite;
+  Sprite *sp;
   Direction direction;
+  int prev_x, prev_y; ///< position before the last simulation step
 } GameUnit;
 
 typedef enum {
   VIRUS1,
-  VIRUS2
+  VIRUS2,
+  NUM_ENEMY_TYPES
 } EnemyType;
 
-typedef struct Enemy {
-  GameUnit *model;
-  EnemyType enemy_type;
-  struct Enemy *next; // storing references to each enemy dynamically, so we can spawn/destroy enemies at runtime
-} Enemy;
+#define MAX_ENEMIES 256
+#define VIRUS2_FRAME_TICKS 10 ///< ticks each frame of the virus 2 animation is shown
+
+/** Refers to an enemy, stays invalid once that enemy is destroyed */
+typedef struct {
+  uint16_t slot;       ///< slot of the enemy in the pool
+  uint16_t generation; ///< generation of the slot when the handle was made
+} EnemyHandle;
+
+/** Every enemy alive, one array per attribute, enemy i being the i-th entry
+ *  of each. Destroying an enemy moves the last one to its index.
+ */
+typedef struct {
+  int count;                          ///< number of enemies, stored at [0, count)
+  int16_t x[MAX_ENEMIES], y[MAX_ENEMIES];
+  int16_t prev_x[MAX_ENEMIES], prev_y[MAX_ENEMIES]; ///< position before the last simulation step
+  uint16_t width[MAX_ENEMIES], height[MAX_ENEMIES];
+  int8_t xspeed[MAX_ENEMIES], yspeed[MAX_ENEMIES];
+  int16_t hp[MAX_ENEMIES];
+  uint8_t type[MAX_ENEMIES];          ///< EnemyType
+  uint8_t frame[MAX_ENEMIES];         ///< current animation frame
+  uint8_t frame_ticks[MAX_ENEMIES];   ///< ticks spent on the current frame
+  uint16_t slot[MAX_ENEMIES];         ///< handle slot of each enemy
+} EnemyPool;
 
 int create_game_elements();
 
 GameUnit* create_static_game_element(uint16_t hp, Sprite *sp, Direction direction);
 
-GameUnit* create_animated_game_element(uint16_t hp, AnimSprite *asp, Direction direction);
+EnemyHandle create_enemy(EnemyType enemy_type, int x, int y);
+
+int get_enemy_index(EnemyHandle handle);
 
-Enemy* create_enemy(void* sp, Direction direction, int x, int y, EnemyType enemy_type);
+EnemyHandle get_enemy_handle(int index);
 
-void destroy_game_element(GameUnit *element,SpriteType type);
+void destroy_enemy(EnemyHandle handle);
 
-void destroy_enemy(Enemy *enemy);
+void destroy_enemy_at(int index);
 
 void free_enemies();
 
@@ -57,6 +73,10 @@ void spawn_enemy(EnemyType new_enemy);
 
 void spawn_enemy_wave();
 
+int find_enemy_at(int x, int y);
+
+int find_enemies_in(int x, int y, int width, int height, EnemyHandle *handles, int max_handles);
+
 void update_enemies();
 
 void calculate_tank_direction();
@@ -65,7 +85,7 @@ void shoot();
 
 GameUnit* get_tank_model();
 
-Enemy* get_enemy_list();
+EnemyPool* get_enemy_pool();
 
 #endif
 
@@ -0,0 +1,185 @@
+/**
+ * @file spatial_grid.c
+ * @brief Implementation of the uniform grid used to find nearby objects.
+ */
+
+#include "spatial_grid.h"
+#include <string.h>
+
+/**
+ * @brief Computes the cell, plus one, holding a position.
+ *
+ * Positions outside the screen go to the nearest border cell.
+ *
+ * @param x The X coordinate.
+ * @param y The Y coordinate.
+ * @return The index + 1 of the cell.
+ */
+
+static uint16_t cell_of(int x, int y) {
+  int col = x < 0 ? 0 : x / GRID_CELL_SIZE;
+  int row = y < 0 ? 0 : y / GRID_CELL_SIZE;
+  if (col >= GRID_COLS)
+    col = GRID_COLS - 1;
+  if (row >= GRID_ROWS)
+    row = GRID_ROWS - 1;
+  return row * GRID_COLS + col + 1;
+}
+
+/**
+ * @brief Links an object at the head of a cell.
+ *
+ * @param grid The grid.
+ * @param id The object.
+ * @param cell The index + 1 of the cell.
+ */
+
+static void grid_link(SpatialGrid *grid, uint16_t id, uint16_t cell) {
+  uint16_t head = grid->head[cell - 1];
+  grid->next[id] = head;
+  grid->prev[id] = 0;
+  if (head != 0)
+    grid->prev[head - 1] = id + 1;
+  grid->head[cell - 1] = id + 1;
+  grid->cell[id] = cell;
+}
+
+/**
+ * @brief Unlinks an object from its cell.
+ *
+ * @param grid The grid.
+ * @param id The object, which must be in the grid.
+ */
+
+static void grid_unlink(SpatialGrid *grid, uint16_t id) {
+  uint16_t next = grid->next[id], prev = grid->prev[id];
+  if (prev != 0)
+    grid->next[prev - 1] = next;
+  else
+    grid->head[grid->cell[id] - 1] = next;
+  if (next != 0)
+    grid->prev[next - 1] = prev;
+  grid->cell[id] = 0;
+}
+
+/**
+ * @brief Empties the grid.
+ *
+ * @param grid The grid.
+ */
+
+void grid_clear(SpatialGrid *grid) {
+  memset(grid, 0, sizeof(*grid));
+}
+
+/**
+ * @brief Adds an object to the grid.
+ *
+ * @param grid The grid.
+ * @param id The object, below GRID_MAX_IDS.
+ * @param x The X coordinate of its top left corner.
+ * @param y The Y coordinate of its top left corner.
+ */
+
+void grid_insert(SpatialGrid *grid, uint16_t id, int x, int y) {
+  if (grid->cell[id] != 0)
+    grid_unlink(grid, id);
+  grid_link(grid, id, cell_of(x, y));
+}
+
+/**
+ * @brief Removes an object from the grid.
+ *
+ * @param grid The grid.
+ * @param id The object.
+ */
+
+void grid_remove(SpatialGrid *grid, uint16_t id) {
+  if (grid->cell[id] != 0)
+    grid_unlink(grid, id);
+}
+
+/**
+ * @brief Updates the position of an object.
+ *
+ * Objects move a few pixels per frame, so most of the time they stay in the
+ * same cell and nothing has to be done.
+ *
+ * @param grid The grid.
+ * @param id The object.
+ * @param x The new X coordinate of its top left corner.
+ * @param y The new Y coordinate of its top left corner.
+ */
+
+void grid_move(SpatialGrid *grid, uint16_t id, int x, int y) {
+  uint16_t cell = cell_of(x, y);
+  if (grid->cell[id] == cell)
+    return;
+  if (grid->cell[id] != 0)
+    grid_unlink(grid, id);
+  grid_link(grid, id, cell);
+}
+
+/**
+ * @brief Finds the objects that may overlap a rectangle.
+ *
+ * An object overlapping the rectangle has its top left corner at most
+ * GRID_MAX_OBJECT_SIZE pixels above or to the left of it, so only the cells
+ * covering that extended area are visited.
+ *
+ * @param grid The grid.
+ * @param x The X coordinate of the rectangle.
+ * @param y The Y coordinate of the rectangle.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ * @param ids Filled with the objects found.
+ * @param max_ids The capacity of ids.
+ * @return The number of objects found.
+ */
+
+int grid_query_rect(const SpatialGrid *grid, int x, int y, int width, int height, uint16_t *ids, int max_ids) {
+  uint16_t first = cell_of(x - GRID_MAX_OBJECT_SIZE, y - GRID_MAX_OBJECT_SIZE) - 1;
+  uint16_t last = cell_of(x + width - 1, y + height - 1) - 1;
+  int num_ids = 0;
+  for (int row = first / GRID_COLS; row <= last / GRID_COLS; row++) {
+    for (int col = first % GRID_COLS; col <= last % GRID_COLS; col++) {
+      for (uint16_t id = grid->head[row * GRID_COLS + col]; id != 0; id = grid->next[id - 1]) {
+        if (num_ids == max_ids)
+          return num_ids;
+        ids[num_ids++] = id - 1;
+      }
+    }
+  }
+  return num_ids;
+}
+
+/**
+ * @brief Finds the objects that may contain a point.
+ *
+ * @param grid The grid.
+ * @param x The X coordinate of the point.
+ * @param y The Y coordinate of the point.
+ * @param ids Filled with the objects found.
+ * @param max_ids The capacity of ids.
+ * @return The number of objects found.
+ */
+
+int grid_query_point(const SpatialGrid *grid, int x, int y, uint16_t *ids, int max_ids) {
+  return grid_query_rect(grid, x, y, 1, 1, ids, max_ids);
+}
+
+/**
+ * @brief Finds the objects that may be near a point.
+ *
+ * @param grid The grid.
+ * @param x The X coordinate of the point.
+ * @param y The Y coordinate of the point.
+ * @param radius The distance on each axis.
+ * @param ids Filled with the objects found.
+ * @param max_ids The capacity of ids.
+ * @return The number of objects found.
+ */
+
+int grid_query_neighbours(const SpatialGrid *grid, int x, int y, int radius, uint16_t *ids, int max_ids) {
+  return grid_query_rect(grid, x - radius, y - radius, 2 * radius + 1, 2 * radius + 1, ids, max_ids);
+}
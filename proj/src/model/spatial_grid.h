@@ -0,0 +1,56 @@
+#ifndef _SPATIAL_GRID_H_
+#define _SPATIAL_GRID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../view/constants.h"
+
+#define GRID_CELL_SIZE 64                                          ///< side of a cell, in pixels
+#define GRID_COLS ((H_RES + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
+#define GRID_ROWS ((V_RES + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
+#define GRID_MAX_OBJECT_SIZE 64                                    ///< objects are at most this wide and tall
+#define GRID_MAX_IDS 256                                           ///< ids go from 0 to GRID_MAX_IDS - 1
+
+/** Uniform grid over the screen. Each object is linked in the cell holding
+ *  its top left corner, links being stored as index + 1 so that a zeroed
+ *  grid is empty.
+ */
+typedef struct {
+  uint16_t head[GRID_ROWS * GRID_COLS]; ///< first object of each cell
+  uint16_t next[GRID_MAX_IDS];          ///< next object in the same cell
+  uint16_t prev[GRID_MAX_IDS];          ///< previous object in the same cell
+  uint16_t cell[GRID_MAX_IDS];          ///< cell of each object, 0 if it is not in the grid
+} SpatialGrid;
+
+/** Empties the grid
+ */
+void grid_clear(SpatialGrid *grid);
+
+/** Adds object "id" with its top left corner at (x, y)
+ */
+void grid_insert(SpatialGrid *grid, uint16_t id, int x, int y);
+
+/** Removes object "id", if it is in the grid
+ */
+void grid_remove(SpatialGrid *grid, uint16_t id);
+
+/** Updates the position of object "id", only relinking it if it changed cell
+ */
+void grid_move(SpatialGrid *grid, uint16_t id, int x, int y);
+
+/** Fills ids with up to max_ids objects that may overlap the rectangle and
+ *  returns how many were found. Objects near the rectangle may be returned
+ *  too, the caller does the exact test.
+ */
+int grid_query_rect(const SpatialGrid *grid, int x, int y, int width, int height, uint16_t *ids, int max_ids);
+
+/** Same as grid_query_rect() for the objects that may contain point (x, y)
+ */
+int grid_query_point(const SpatialGrid *grid, int x, int y, uint16_t *ids, int max_ids);
+
+/** Same as grid_query_rect() for the objects that may be within "radius"
+ *  pixels of point (x, y) on both axes
+ */
+int grid_query_neighbours(const SpatialGrid *grid, int x, int y, int radius, uint16_t *ids, int max_ids);
+
+#endif
@@ -6,15 +6,14 @@
 #include <lcom/lcf.h>
 #include "device/mouse.h"
 #include "device/keyboard.h"
+#include "device/kbc.h"
 #include "dispatcher/dispatcher.h"
 #include "menu/menu.h"
 #include "graphics/sprite.h"
-#include <lcom/timer.h>
+#include "bench/bench.h"
+#include "device/timer.h"
 
-extern uint8_t keyboard_data,mouse_data,kbd_status_byte,mouse_status_byte,mouse_count;
-struct packet mouse_packet;
-bool discard_mouse_data,discard_keyboard_data,skip_print,game_running = true;
-extern int timer_counter;
+bool game_running = true;
 
 int main(int argc, char *argv[]) {
   // sets the language of LCF messages (can be either EN-US or PT-PT)
@@ -46,21 +45,23 @@ int main(int argc, char *argv[]) {
  * This function initializes the game state and enters a loop that continues until the game state is KILL.
  * Within the loop, it receives messages and handles them based on their type and source.
  * It handles hardware interrupts for the mouse, keyboard, and timer, processing the respective data and updating the game state.
+ * Either KBC interrupt drains every byte waiting in the output buffer, and the scancodes and packets decoded are handled in order.
  * After the loop, it performs cleanup by unsubscribing from the interrupts and disabling the mouse data report.
+ * When arguments are given, the named benchmark is run instead of the game (see bench/bench.h).
  * 
  * @param argc The number of strings pointed to by argv
  * @param argv A pointer to an array of arguments
  * @return int Returns 0 upon successful execution
  */
 int (proj_main_loop)(int argc, char **argv) {
+  if (argc > 0)
+    return run_benchmark(argc, argv);
+
   vg_init(0x115);
   int ipc_status;
   int r;
   uint8_t irq_set_mouse,irq_set_kbd, irq_set_timer;
   message msg;
-  uint8_t bytes[2];
-  uint8_t size = 1;
-  bool is_make;
 
   kbc_issue_mouse_cmd(ENABLE_DATA_REPORT);
   m_kbc_subscribe_int(&irq_set_mouse);
@@ -78,41 +79,20 @@ int (proj_main_loop)(int argc, char **argv) {
     if (is_ipc_notify(ipc_status)) {                     /* received notification */
       switch (_ENDPOINT_P(msg.m_source)) {               
         case HARDWARE:                                   /* hardware interrupt notification */
-          if (msg.m_notify.interrupts & irq_set_mouse) { /* subscribed interrupt */
-            mouse_ih();
-            if (discard_mouse_data == false) {
-              mouse_packet_handler(&mouse_packet);
-              
-              if (mouse_count == 3) {
-                mouse_state_handler(&mouse_packet);
-                //mouse_print_packet(&mouse_packet);
-                mouse_count = 0;
-              }
-            }
-            discard_mouse_data = false;
+          if (msg.m_notify.interrupts & (irq_set_mouse | irq_set_kbd)) { /* subscribed interrupt */
+            if (msg.m_notify.interrupts & irq_set_mouse)
+              mouse_ih();
+            else
+              kbc_ih(); // the events wait in the input queue for the next tick
           }
           if (msg.m_notify.interrupts & irq_set_timer) { /* subscribed interrupt */
             timer_int_handler(); // timer_counter++
-            
-            // timer 0 generates interrupts 60 per second by default
-            //            30 fps
-            if(timer_counter%2==0){
-              game_state_handler();
-            }
+
+            // timer 0 generates interrupts 60 per second by default: a frame
+            // is drawn on each, the game advancing 30 steps per second of clock;
+            // the input queued since the last one is handled first
+            timer_state_handler(timer_clock_us());
           }  
-          if (msg.m_notify.interrupts & irq_set_kbd) { /* subscribed interrupt */
-            kbc_ih();
-            if (discard_keyboard_data == false){
-              process_scancode(&is_make,&size,bytes);
-              if (!skip_print){
-                kbd_state_handler(is_make,size,bytes);
-                //kbd_print_scancode(is_make,size,bytes);
-                size = 1;
-              }
-            }
-            discard_keyboard_data = false;
-            timer_counter = 0;
-          }
           break;
         default:
           break; /* no other notifications expected: do nothing */
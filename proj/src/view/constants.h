@@ -26,6 +26,8 @@
 #define TITLE_FONT_HEIGHT 39
 
 #define HYSTERESIS_THRESHOLD 30.0
+#define TANK_STEP 4          ///< pixels the tank moves per simulation step along an axis
+#define TANK_DIAGONAL_STEP 3 ///< pixels per axis on a diagonal, TANK_STEP / sqrt(2) rounded
 
 
 #endif // _CONSTANTS_H_
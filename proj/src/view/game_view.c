@@ -4,10 +4,30 @@
  */
 #include "game_view.h"
 
-static Sprite *crosshair, *cursor, *tank_sprite;
-uint8_t *tank_sprites[NUM_DIRECTIONS], *game_letters_ptr, *game_numbers_ptr;
-xpm_image_t tank_images[NUM_DIRECTIONS], game_letters, game_numbers;
-Explosion *explosion_list = NULL;
+static Sprite *crosshair, *cursor, *tank_sprite, *virus1;
+uint8_t *tank_sprites[NUM_DIRECTIONS];
+SpanMap *tank_spans[NUM_DIRECTIONS];
+xpm_image_t tank_images[NUM_DIRECTIONS];
+Font game_letters, game_numbers;
+static AnimFrames *anim_frames[NUM_ANIM_ASSETS];
+static Explosion explosions[MAX_EXPLOSIONS];
+static uint32_t num_explosions_created = 0;
+static TextLayer hud_layers[NUM_HUD_LAYERS];
+
+/// @brief Font and position of each HUD layer.
+static const struct {
+  Font *font;
+  int x, y;
+} hud_layout[NUM_HUD_LAYERS] = {
+  [HUD_SCORE_LABEL] = {&game_letters, 21, 0},
+  [HUD_SCORE] = {&game_numbers, 147, 0},
+  [HUD_TIME_LABEL] = {&game_letters, 611, 0},
+  [HUD_TIME] = {&game_numbers, 716, 0},
+  [HUD_HP_LABEL] = {&game_letters, 21, 580},
+  [HUD_HP] = {&game_numbers, 84, 580},
+  [HUD_WAVE_LABEL] = {&game_letters, 611, 580},
+  [HUD_WAVE] = {&game_numbers, 716, 580},
+};
 
 /**
  * @brief Loads game sprites into memory.
@@ -15,21 +35,22 @@ Explosion *explosion_list = NULL;
  * @return 0 on success.
  */
 int load_game_sprites() {
-  tank_sprites[0] = xpm_load(tank1_xpm, XPM_8_8_8, &tank_images[0]);
-  tank_sprites[1] = xpm_load(tank2_xpm, XPM_8_8_8, &tank_images[1]);
-  tank_sprites[2] = xpm_load(tank3_xpm, XPM_8_8_8, &tank_images[2]);
-  tank_sprites[3] = xpm_load(tank4_xpm, XPM_8_8_8, &tank_images[3]);
-  tank_sprites[4] = xpm_load(tank5_xpm, XPM_8_8_8, &tank_images[4]);
-  tank_sprites[5] = xpm_load(tank6_xpm, XPM_8_8_8, &tank_images[5]);
-  tank_sprites[6] = xpm_load(tank7_xpm, XPM_8_8_8, &tank_images[6]);
-  tank_sprites[7] = xpm_load(tank8_xpm, XPM_8_8_8, &tank_images[7]);
-  tank_sprites[8] = xpm_load(tank9_xpm, XPM_8_8_8, &tank_images[8]);
-  tank_sprites[9] = xpm_load(tank10_xpm, XPM_8_8_8, &tank_images[9]);
-  tank_sprites[10] = xpm_load(tank11_xpm, XPM_8_8_8, &tank_images[10]);
-  tank_sprites[11] = xpm_load(tank12_xpm, XPM_8_8_8, &tank_images[11]);
-  tank_sprite = create_sprite((const char **) tank9_xpm, 500, 300, 0, 0);
-  crosshair = create_sprite((const char **) crosshair_xpm, 400, 300, 5, 5);
-  cursor = create_sprite((const char **) cursor_xpm, 400, 300, 0, 0);
+  for (int i = 0; i < NUM_DIRECTIONS; i++) {
+    tank_sprites[i] = load_asset(ASSET_TANK1 + i, &tank_images[i]);
+    tank_spans[i] = compile_spans(tank_sprites[i], tank_images[i].width, 0, tank_images[i].width, tank_images[i].height);
+    vg_pack_pixmap(tank_sprites[i], (size_t) tank_images[i].width * tank_images[i].height);
+  }
+  tank_sprite = create_sprite(ASSET_TANK9, 500, 300, 0, 0);
+  // draw_tank() draws the direction pixmaps above, the sprite only keeps the tank's box
+  free(tank_sprite->map);
+  free_spans(tank_sprite->spans);
+  tank_sprite->map = tank_sprites[8];
+  tank_sprite->spans = tank_spans[8];
+  crosshair = create_sprite(ASSET_CROSSHAIR, 400, 300, 5, 5);
+  cursor = create_sprite(ASSET_CURSOR, 400, 300, 0, 0);
+  virus1 = create_sprite(ASSET_VIRUS40, 0, 0, 1, 1);
+  anim_frames[ANIM_VIRUS2] = load_anim_frames(ASSET_VIRUS50_1, 5);
+  anim_frames[ANIM_EXPLOSION] = load_anim_frames(ASSET_EXPLOSION1, 20);
   return 0;
 }
 
@@ -41,147 +62,141 @@ void free_game_sprites() {
     if (tank_sprites[i] != NULL) {
       free(tank_sprites[i]);
     }
+    free_spans(tank_spans[i]);
   }
+  tank_sprite->map = NULL;
+  tank_sprite->spans = NULL;
   destroy_sprite(tank_sprite);
   destroy_sprite(crosshair);
   destroy_sprite(cursor);
+  destroy_sprite(virus1);
+  for (int i = 0; i < MAX_EXPLOSIONS; i++) {
+    explosions[i].active = false;
+  }
+  for (int i = 0; i < NUM_ANIM_ASSETS; i++) {
+    free_anim_frames(anim_frames[i]);
+    anim_frames[i] = NULL;
+  }
 }
 
 /**
  * @brief Loads game fonts into memory.
  */
 void load_game_fonts() {
-  game_letters_ptr = xpm_load(game_letters_xpm, XPM_8_8_8, &game_letters);
-  game_numbers_ptr = xpm_load(game_numbers_xpm, XPM_8_8_8, &game_numbers);
+  load_font(&game_letters, ASSET_GAME_LETTERS, LETTERS_NUM, GAME_FONT_WIDTH, GAME_FONT_HEIGHT, GAME_FONT_OFFSET);
+  load_font(&game_numbers, ASSET_GAME_NUMBERS, NUMBERS_NUM, GAME_FONT_WIDTH, GAME_FONT_HEIGHT, GAME_FONT_OFFSET);
 }
 
 /**
  * @brief Frees memory allocated for game fonts.
  */
 void free_game_fonts() {
-  free(game_letters_ptr);
-  free(game_numbers_ptr);
+  free_font(&game_letters);
+  free_font(&game_numbers);
 }
+
 /**
- * @brief Creates an animated sprite for a virus type 2 enemy.
+ * @brief Retrieves the shared frames of an animated asset.
+ * 
+ * The frames are decoded once by load_game_sprites() and must not be modified.
  * 
- * @param x X-coordinate of the sprite.
- * @param y Y-coordinate of the sprite.
- * @return Pointer to the created animated sprite.
+ * @param asset The animated asset.
+ * @return Pointer to the frames, or NULL if they are not loaded.
  */
-AnimSprite *create_virus2_asprite(int x, int y) {
-  AnimSprite *new_enemy_asprite = create_asprite(10, 5, (const char **) virus50_1_xpm, (const char **) virus50_2_xpm, (const char **) virus50_3_xpm, (const char **) virus50_4_xpm,
-                                                 (const char **) virus50_5_xpm);
-  new_enemy_asprite->sp->xspeed = 2;
-  new_enemy_asprite->sp->yspeed = 2;
-  return new_enemy_asprite;
+const AnimFrames *get_anim_frames(AnimAsset asset) {
+  return anim_frames[asset];
 }
 
 /**
- * @brief Creates a static sprite for a virus type 1 enemy.
+ * @brief Gets the pixmap of the tank facing a direction.
  * 
- * @param x X-coordinate of the sprite.
- * @param y Y-coordinate of the sprite.
- * @return Pointer to the created sprite.
+ * The directions have pixmaps of different sizes, which the tank takes as
+ * its size when it turns.
+ * 
+ * @param direction The direction.
+ * @return Pointer to the image, loaded by load_game_sprites().
  */
-Sprite *create_virus1_sprite(int x, int y) {
-  Sprite *new_enemy = create_sprite((const char **) virus40_xpm, x, y, 1, 1);
-  return new_enemy;
+const xpm_image_t *get_tank_image(Direction direction) {
+  return &tank_images[direction];
 }
 
 /**
  * @brief Creates an explosion effect at the specified coordinates.
  * 
+ * Explosions live in a fixed pool and play the shared explosion frames, so
+ * no memory is allocated. When every slot is busy the oldest one, the first
+ * created of them, is reused.
+ * 
  * @param x X-coordinate of the explosion.
  * @param y Y-coordinate of the explosion.
  * @return Pointer to the created explosion.
  */
 Explosion *create_explosion(int x, int y) {
-  Explosion *new_explosion = malloc(sizeof(Explosion));
-  AnimSprite *new_asp = create_asprite(3, 20, (const char **) explosion1_xpm, (const char **) explosion2_xpm, (const char **) explosion3_xpm, (const char **) explosion4_xpm,
-                                       (const char **) explosion5_xpm, (const char **) explosion6_xpm, (const char **) explosion7_xpm, (const char **) explosion8_xpm, (const char **) explosion9_xpm, (const char **) explosion10_xpm,
-                                       (const char **) explosion11_xpm, (const char **) explosion12_xpm, (const char **) explosion13_xpm, (const char **) explosion14_xpm, (const char **) explosion15_xpm, (const char **) explosion16_xpm,
-                                       (const char **) explosion17_xpm, (const char **) explosion18_xpm, (const char **) explosion19_xpm, (const char **) explosion20_xpm);
-  new_explosion->explosion_asp = new_asp;
-  new_explosion->explosion_asp->sp->x = x;
-  new_explosion->explosion_asp->sp->y = y;
-  new_explosion->next = explosion_list;
-  explosion_list = new_explosion;
+  Explosion *new_explosion = &explosions[0];
+  for (int i = 0; i < MAX_EXPLOSIONS; i++) {
+    if (!explosions[i].active) {
+      new_explosion = &explosions[i];
+      break;
+    }
+    if (explosions[i].created < new_explosion->created)
+      new_explosion = &explosions[i];
+  }
+  init_asprite(&new_explosion->explosion_asp, anim_frames[ANIM_EXPLOSION], 3, x, y);
+  new_explosion->active = true;
+  new_explosion->created = num_explosions_created++;
   return new_explosion;
 }
 
 /**
- * @brief Destroys an explosion and frees associated memory.
+ * @brief Destroys an explosion, releasing its slot in the pool.
  * 
  * @param explosion Pointer to the explosion to destroy.
  */
 void destroy_explosion(Explosion *explosion) {
-  Explosion **current = &explosion_list;
-  while (*current != NULL) {
-    if (*current == explosion) {
-      Explosion *to_free = *current;
-      *current = (*current)->next;
-      destroy_asprite(to_free->explosion_asp);
-      free(to_free);
-      return;
-    }
-    current = &((*current)->next);
-  }
+  explosion->active = false;
 }
 
 /**
  * @brief Draws the tank sprite on the screen.
  * 
+ * The pixmap of the direction the simulation turned the tank to is drawn,
+ * between its positions before and after the last step, like the enemies.
+ * 
+ * @param alpha How far the frame is past the last step, out of INTERP_ONE.
  * @return 0 on success.
  */
-int draw_tank() {
-    static Direction last_direction = -1;
-    static int last_tank_x = -1, last_tank_y = -1;
-    GameUnit *tank = get_tank_model();
-    int current_x = tank->sprite.sp->x;
-    int current_y = tank->sprite.sp->y;
-
-    // Only update the sprite if the direction or position has changed
-    if (last_direction != tank->direction || last_tank_x != current_x || last_tank_y != current_y) {
-        // Temporarily set the new sprite properties
-        tank->sprite.sp->map = tank_sprites[tank->direction];
-        tank->sprite.sp->width = tank_images[tank->direction].width;
-        tank->sprite.sp->height = tank_images[tank->direction].height;
-
-        // Check for collision
-        if (!arena_collision(tank->sprite.sp)) {
-            // Update only if there's no collision
-            last_direction = tank->direction;
-            last_tank_x = current_x;
-            last_tank_y = current_y;
-        } else {
-            // Revert changes if there's a collision
-            tank->sprite.sp->map = tank_sprites[last_direction];
-            tank->sprite.sp->width = tank_images[last_direction].width;
-            tank->sprite.sp->height = tank_images[last_direction].height;
-        }
-    }
-
-    draw_sprite(tank->sprite.sp);
-    return 0;
+int draw_tank(int alpha) {
+  GameUnit *tank = get_tank_model();
+  Direction direction = tank->direction;
+  int x = tank->prev_x + (tank->sp->x - tank->prev_x) * alpha / INTERP_ONE;
+  int y = tank->prev_y + (tank->sp->y - tank->prev_y) * alpha / INTERP_ONE;
+  draw_spans(tank_spans[direction], tank_sprites[direction], get_drawing_buffer(), get_h_res(), get_v_res(), x, y);
+  vg_mark_dirty(x, y, tank_images[direction].width, tank_images[direction].height);
+  return 0;
 }
 
 /**
  * @brief Draws enemy sprites on the screen.
  * 
+ * Every enemy of a type shares the same pixmaps, the pool only holds where
+ * each one is and which animation frame it shows. Each enemy is drawn between
+ * its positions before and after the last simulation step.
+ * 
+ * @param alpha How far the frame is past the last step, out of INTERP_ONE.
  * @return 0 on success.
  */
-int draw_enemies() {
-  Enemy *current = get_enemy_list();
-  while (current != NULL) {
-    if (current->model->type == STATIC_SPRITE) {
-      draw_sprite(current->model->sprite.sp);
+int draw_enemies(int alpha) {
+  EnemyPool *enemies = get_enemy_pool();
+  const AnimFrames *virus2 = anim_frames[ANIM_VIRUS2];
+  for (int i = 0; i < enemies->count; i++) {
+    int x = enemies->prev_x[i] + (enemies->x[i] - enemies->prev_x[i]) * alpha / INTERP_ONE;
+    int y = enemies->prev_y[i] + (enemies->y[i] - enemies->prev_y[i]) * alpha / INTERP_ONE;
+    if (enemies->type[i] == VIRUS1) {
+      draw_sprite_at(virus1, x, y);
     }
-    if (current->model->type == ANIMATED_SPRITE) {
-      draw_sprite(current->model->sprite.asp->sp);
-      animate_asprite(current->model->sprite.asp, false);
+    if (enemies->type[i] == VIRUS2) {
+      draw_anim_frame(virus2, enemies->frame[i], x, y);
     }
-    current = current->next;
   }
   return 0;
 }
@@ -192,28 +207,48 @@ int draw_enemies() {
  * @return 0 on success.
  */
 int draw_explosions() {
-  Explosion *current = explosion_list;
-  while (current != NULL) {
-    draw_sprite(current->explosion_asp->sp);
-    Explosion *next = current->next;
-    if (animate_asprite(current->explosion_asp, true) == 1) {
-      destroy_explosion(current);
-    };
-    current = next;
+  for (int i = 0; i < MAX_EXPLOSIONS; i++) {
+    if (explosions[i].active)
+      draw_sprite(&explosions[i].explosion_asp.sp);
   }
   return 0;
 }
 
 /**
- * @brief Draws the crosshair sprite on the screen.
+ * @brief Advances the enemy and explosion animations by one simulation step.
+ * 
+ * Finished explosions are destroyed.
+ */
+void update_animations() {
+  EnemyPool *enemies = get_enemy_pool();
+  const AnimFrames *virus2 = anim_frames[ANIM_VIRUS2];
+  for (int i = 0; i < enemies->count; i++) {
+    if (enemies->type[i] != VIRUS2)
+      continue;
+    if (enemies->frame_ticks[i] >= VIRUS2_FRAME_TICKS) {
+      enemies->frame_ticks[i] = 0;
+      enemies->frame[i] = (enemies->frame[i] + 1) % virus2->num_fig;
+    }
+    else {
+      enemies->frame_ticks[i]++;
+    }
+  }
+  for (int i = 0; i < MAX_EXPLOSIONS; i++) {
+    Explosion *current = &explosions[i];
+    if (current->active && animate_asprite(&current->explosion_asp, true) == 1) {
+      destroy_explosion(current);
+    }
+  }
+}
+
+/**
+ * @brief Draws the crosshair sprite on the screen, while it trails the cursor.
  * 
  * @return 0 on success.
  */
 
 int draw_crosshair() {
   if ((crosshair->x != cursor->x) || (crosshair->y != cursor->y)) {
-    move_sprite_to(crosshair, cursor->x, cursor->y, false);
-    calculate_tank_direction();
     draw_sprite(crosshair);
   }
   return 0;
@@ -233,11 +268,12 @@ int draw_cursor() {
 /**
  * @brief Draws all game elements on the screen.
  * 
+ * @param alpha How far the frame is past the last simulation step, out of INTERP_ONE.
  * @return 0 on success.
  */
-int draw_elements() {
-  draw_tank();
-  draw_enemies();
+int draw_elements(int alpha) {
+  draw_tank(alpha);
+  draw_enemies(alpha);
   draw_crosshair();
   draw_cursor();
   return 0;
@@ -246,40 +282,50 @@ int draw_elements() {
 /**
  * @brief Draws the game arena on the screen.
  * 
- * @return 0 on success.
+ * The arena is the next one of the rotation, usually prefetched while a menu
+ * was shown, and the tank is moved to its starting point. The HUD lives in the header and footer of the arena background,
+ * so it is drawn again from scratch.
+ * 
+ * @return 0 on success, 1 if the arena could not be loaded.
  */
 
 int draw_arena() {
-  create_arena(arena3_xpm, 0x007B35);
+  const ArenaInfo *arena = enter_next_arena();
+  if (arena == NULL)
+    return 1;
+  // the arenas differ, so the tank starts where it is clear in this one
+  tank_sprite->x = arena->tank_x;
+  tank_sprite->y = arena->tank_y;
+  tank_sprite->width = tank_images[get_tank_model()->direction].width;
+  tank_sprite->height = tank_images[get_tank_model()->direction].height;
+  get_tank_model()->prev_x = arena->tank_x;
+  get_tank_model()->prev_y = arena->tank_y;
+  for (int i = 0; i < NUM_HUD_LAYERS; i++) {
+    init_text_layer(&hud_layers[i], hud_layout[i].font, hud_layout[i].x, hud_layout[i].y, 0x000000);
+  }
+  set_layer_text(&hud_layers[HUD_SCORE_LABEL], "SCORE");
+  set_layer_text(&hud_layers[HUD_TIME_LABEL], "TIME");
+  set_layer_text(&hud_layers[HUD_HP_LABEL], "HP");
+  set_layer_text(&hud_layers[HUD_WAVE_LABEL], "WAVE");
   return 0;
 }
 
 /**
  * @brief Draws the header section of the game interface.
  * 
+ * The score and time are only drawn again when they change.
+ * 
  * @return 0 on success.
  */
 
 int draw_header() {
-  vg_draw_rectangle(0, 0, ARENA_WIDTH, 20, 0);
   GameState state = get_game_state();
-  int score = state.score;
-  int game_time = state.game_time;
-
-  char *score_str = (char *) malloc(sizeof(char) * 20);
-
-  sprintf(score_str, "%d", score);
+  char str[TEXT_LAYER_LEN + 1];
 
-  char *game_time_str = (char *) malloc(sizeof(char) * 20);
-
-  sprintf(game_time_str, "%d", game_time);
-  draw_string("SCORE", 21, 0, GAME_FONT_OFFSET, GAME_FONT_HEIGHT, GAME_FONT_WIDTH, game_letters_ptr, game_letters);
-  draw_string(score_str, 147, 0, GAME_FONT_OFFSET, GAME_FONT_HEIGHT, GAME_FONT_WIDTH, game_numbers_ptr, game_numbers);
-  draw_string("TIME", 611, 0, GAME_FONT_OFFSET, GAME_FONT_HEIGHT, GAME_FONT_WIDTH, game_letters_ptr, game_letters);
-  draw_string(game_time_str, 716, 0, GAME_FONT_OFFSET, GAME_FONT_HEIGHT, GAME_FONT_WIDTH, game_numbers_ptr, game_numbers);
-
-  free(score_str);
-  free(game_time_str);
+  snprintf(str, sizeof(str), "%u", state.score);
+  set_layer_text(&hud_layers[HUD_SCORE], str);
+  snprintf(str, sizeof(str), "%u", state.game_time);
+  set_layer_text(&hud_layers[HUD_TIME], str);
 
   return 0;
 }
@@ -287,29 +333,18 @@ int draw_header() {
 /**
  * @brief Draws the footer section of the game interface.
  * 
+ * The hp and wave are only drawn again when they change.
+ * 
  * @return 0 on success.
  */
 
 int draw_footer() {
-  vg_draw_rectangle(0, 580, ARENA_WIDTH, 20, 0);
-  GameState state = get_game_state();
-  int hp = get_tank_model()->hp;
-  int wave = state.difficulty;
-
-  char *hp_str = (char *) malloc(sizeof(char) * 10);
-
-  sprintf(hp_str, "%d", hp);
+  char str[TEXT_LAYER_LEN + 1];
 
-  char *wave_str = (char *) malloc(sizeof(char) * 20);
-
-  sprintf(wave_str, "%d", wave);
-  draw_string("HP", 21, 580, GAME_FONT_OFFSET, GAME_FONT_HEIGHT, GAME_FONT_WIDTH, game_letters_ptr, game_letters);
-  draw_string(hp_str, 84, 580, GAME_FONT_OFFSET, GAME_FONT_HEIGHT, GAME_FONT_WIDTH, game_numbers_ptr, game_numbers);
-  draw_string("WAVE", 611, 580, GAME_FONT_OFFSET, GAME_FONT_HEIGHT, GAME_FONT_WIDTH, game_letters_ptr, game_letters);
-  draw_string(wave_str, 716, 580, GAME_FONT_OFFSET, GAME_FONT_HEIGHT, GAME_FONT_WIDTH, game_numbers_ptr, game_numbers);
-
-  free(hp_str);
-  free(wave_str);
+  snprintf(str, sizeof(str), "%u", get_tank_model()->hp);
+  set_layer_text(&hud_layers[HUD_HP], str);
+  snprintf(str, sizeof(str), "%u", get_difficulty());
+  set_layer_text(&hud_layers[HUD_WAVE], str);
 
   return 0;
 }
@@ -317,16 +352,21 @@ int draw_footer() {
 /**
  * @brief Draws the game interface.
  * 
+ * Nothing is simulated here, the game only advances in update_game().
+ * 
+ * @param alpha How far the frame is past the last simulation step, out of INTERP_ONE.
  * @return 0 on success.
  */
 
-int draw_game() {
-  draw_explosions();
-  update_enemies();
+int draw_game(int alpha) {
+  // the HUD redraws parts of the background, so it goes before the rest
+  profile_start(PROFILE_HUD);
   draw_header();
   draw_footer();
+  profile_stop(PROFILE_HUD);
+  draw_explosions();
   draw_timer();
-  draw_elements();
+  draw_elements(alpha);
   return 0;
 }
 
@@ -8,60 +8,39 @@
 #include "../model/game_model.h"
 #include "../view/constants.h"
 #include "../logic/game_logic.h"
+#include "../logic/direction.h"
 #include "../model/arena.h"
+#include "../model/arena_manager.h"
 #include "../menu/menu.h"
-#include "../../assets/xpm/objects/tank1.xpm"
-#include "../../assets/xpm/objects/tank2.xpm"
-#include "../../assets/xpm/objects/tank3.xpm"
-#include "../../assets/xpm/objects/tank4.xpm"
-#include "../../assets/xpm/objects/tank5.xpm"
-#include "../../assets/xpm/objects/tank6.xpm"
-#include "../../assets/xpm/objects/tank7.xpm"
-#include "../../assets/xpm/objects/tank8.xpm"
-#include "../../assets/xpm/objects/tank9.xpm"
-#include "../../assets/xpm/objects/tank10.xpm"
-#include "../../assets/xpm/objects/tank11.xpm"
-#include "../../assets/xpm/objects/tank12.xpm"
-#include "../../assets/xpm/crosshair.xpm"
-#include "../../assets/xpm/cursor.xpm"
-#include "../../assets/xpm/arenas/arena1.xpm"
-#include "../../assets/xpm/arenas/arena2.xpm"
-#include "../../assets/xpm/arenas/arena3.xpm"
-#include "../../assets/xpm/arenas/arena4.xpm"
-#include "../../assets/xpm/arenas/arena5.xpm"
-#include "../../assets/xpm/objects/virus40.xpm"
-#include "../../assets/xpm/objects/virus50_1.xpm"
-#include "../../assets/xpm/objects/virus50_2.xpm"
-#include "../../assets/xpm/objects/virus50_3.xpm"
-#include "../../assets/xpm/objects/virus50_4.xpm"
-#include "../../assets/xpm/objects/virus50_5.xpm"
-#include "../../assets/xpm/explosion/explosion1.xpm"
-#include "../../assets/xpm/explosion/explosion2.xpm"
-#include "../../assets/xpm/explosion/explosion3.xpm"
-#include "../../assets/xpm/explosion/explosion4.xpm"
-#include "../../assets/xpm/explosion/explosion5.xpm"
-#include "../../assets/xpm/explosion/explosion6.xpm"
-#include "../../assets/xpm/explosion/explosion7.xpm"
-#include "../../assets/xpm/explosion/explosion8.xpm"
-#include "../../assets/xpm/explosion/explosion9.xpm"
-#include "../../assets/xpm/explosion/explosion10.xpm"
-#include "../../assets/xpm/explosion/explosion11.xpm"
-#include "../../assets/xpm/explosion/explosion12.xpm"
-#include "../../assets/xpm/explosion/explosion13.xpm"
-#include "../../assets/xpm/explosion/explosion14.xpm"
-#include "../../assets/xpm/explosion/explosion15.xpm"
-#include "../../assets/xpm/explosion/explosion16.xpm"
-#include "../../assets/xpm/explosion/explosion17.xpm"
-#include "../../assets/xpm/explosion/explosion18.xpm"
-#include "../../assets/xpm/explosion/explosion19.xpm"
-#include "../../assets/xpm/explosion/explosion20.xpm"
-#include "../../assets/xpm/text/game_letters.xpm"
-#include "../../assets/xpm/text/game_numbers.xpm"
-
-
-typedef struct Explosion {
-    AnimSprite *explosion_asp;
-    struct Explosion *next;
+#include "../bench/profile.h"
+
+
+#define MAX_EXPLOSIONS 16
+#define INTERP_ONE 256 ///< interpolation factor of a frame drawn on a simulation step
+
+typedef enum {
+    ANIM_VIRUS2,
+    ANIM_EXPLOSION,
+    NUM_ANIM_ASSETS
+} AnimAsset;
+
+/** Texts of the HUD, kept in the header and footer of the arena background */
+typedef enum {
+    HUD_SCORE_LABEL,
+    HUD_SCORE,
+    HUD_TIME_LABEL,
+    HUD_TIME,
+    HUD_HP_LABEL,
+    HUD_HP,
+    HUD_WAVE_LABEL,
+    HUD_WAVE,
+    NUM_HUD_LAYERS
+} HudLayer;
+
+typedef struct {
+    AnimSprite explosion_asp;
+    bool active;
+    uint32_t created; ///< number of explosions created before this one, orders them by age
 } Explosion;
 
 
@@ -73,30 +52,32 @@ void load_game_fonts();
 
 void free_game_fonts();
 
+const AnimFrames* get_anim_frames(AnimAsset asset);
 
-Sprite* create_virus1_sprite(int x, int y);
+const xpm_image_t* get_tank_image(Direction direction);
 
-AnimSprite *create_virus2_asprite(int x, int y);
 
 Explosion* create_explosion(int x, int y);
 
 void destroy_explosion(Explosion *explosion);
 
-int draw_tank();
+int draw_tank(int alpha);
 
-int draw_enemies();
+int draw_enemies(int alpha);
 
 int draw_explosions();
 
+void update_animations();
+
 int draw_crosshair();
 
 int draw_cursor();
 
-int draw_game();
+int draw_game(int alpha);
 
 int draw_header();
 
-int draw_elements();
+int draw_elements(int alpha);
 
 int draw_footer();
 
@@ -0,0 +1,224 @@
+/**
+ * @file xpm_bake.c
+ * @brief Host tool that converts an XPM asset into a baked pixmap blob.
+ *
+ * The game parses every XPM with xpm_load() at runtime, which is slow for the
+ * 800x600 menus and the arenas (thousands of colours, 2 or 3 chars per pixel).
+ * This tool does that work once, at build time, and writes the decoded
+ * pixels in the exact layout xpm_load(XPM_8_8_8) produces, followed by a
+ * transparency mask. See ../src/graphics/baked.h for the blob format.
+ *
+ * Usage: xpm_bake <input.xpm> <output.bin>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BAKED_MAGIC "BBPX"
+#define BAKED_VERSION 1
+#define BAKED_HEADER_SIZE 16
+#define CHROMA_KEY_GREEN_888 0x00b140 /* same key as <lcom/xpm.h> */
+
+#define XPM_CHARS 95   /* printable characters usable in XPM pixels */
+#define MAX_CPP 3      /* every asset uses 1 to 3 chars per pixel */
+#define TRANSPARENT 0xFFFFFFFF
+#define UNDEFINED 0xFFFFFFFE  /* pixel chars no colour line defines */
+
+/**
+ * @brief Reads a whole file into a NUL terminated buffer.
+ */
+static char *read_file(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *text = malloc(size + 1);
+  if (text == NULL || fread(text, 1, size, f) != (size_t) size) {
+    free(text);
+    fclose(f);
+    return NULL;
+  }
+  text[size] = '\0';
+  fclose(f);
+  return text;
+}
+
+/**
+ * @brief Splits the C source of an XPM into its string literals.
+ *
+ * The literals are unescaped in place and stored in rows.
+ *
+ * @return The number of rows found
+ */
+static int extract_rows(char *text, char ***rows) {
+  int capacity = 1024, count = 0;
+  *rows = malloc(capacity * sizeof(char *));
+  if (*rows == NULL)
+    return 0;
+  char *p = text;
+  // skip the "/* XPM */" comment and the declaration up to the opening brace
+  p = strchr(p, '{');
+  if (p == NULL)
+    return 0;
+  while ((p = strchr(p, '"')) != NULL) {
+    char *start = ++p, *out = p;
+    while (*p && *p != '"') {
+      if (*p == '\\' && p[1])
+        p++;
+      *out++ = *p++;
+    }
+    if (*p == '\0')
+      break;
+    *out = '\0';
+    p++;
+    if (count == capacity) {
+      capacity *= 2;
+      char **grown = realloc(*rows, capacity * sizeof(char *));
+      if (grown == NULL)
+        return 0;
+      *rows = grown;
+    }
+    (*rows)[count++] = start;
+  }
+  return count;
+}
+
+/**
+ * @brief Computes the colour table index of a pixel made of cpp chars.
+ */
+static int pixel_key(const char *chars, int cpp) {
+  int key = 0;
+  for (int i = 0; i < cpp; i++)
+    key = key * XPM_CHARS + (unsigned char) (chars[i] - ' ') % XPM_CHARS;
+  return key;
+}
+
+/**
+ * @brief Writes a 16 bit little endian value.
+ */
+static void put16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+/**
+ * @brief Writes a 32 bit little endian value.
+ */
+static void put32(uint8_t *p, uint32_t v) {
+  put16(p, v & 0xFFFF);
+  put16(p + 2, v >> 16);
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <input.xpm> <output.bin>\n", argv[0]);
+    return 1;
+  }
+
+  char *text = read_file(argv[1]);
+  if (text == NULL) {
+    fprintf(stderr, "xpm_bake: cannot read %s\n", argv[1]);
+    return 1;
+  }
+  char **rows;
+  int num_rows = extract_rows(text, &rows);
+  int width, height, num_colors, cpp;
+  if (num_rows < 1 || sscanf(rows[0], "%d %d %d %d", &width, &height, &num_colors, &cpp) != 4 ||
+      cpp < 1 || cpp > MAX_CPP || num_rows < 1 + num_colors + height) {
+    fprintf(stderr, "xpm_bake: %s is not a valid XPM\n", argv[1]);
+    return 1;
+  }
+
+  // colour table indexed directly by the pixel chars
+  int table_size = 1;
+  for (int i = 0; i < cpp; i++)
+    table_size *= XPM_CHARS;
+  uint32_t *table = malloc(table_size * sizeof(uint32_t));
+  if (table == NULL) {
+    fprintf(stderr, "xpm_bake: out of memory\n");
+    return 1;
+  }
+  for (int i = 0; i < table_size; i++)
+    table[i] = UNDEFINED;
+  for (int i = 0; i < num_colors; i++) {
+    const char *row = rows[1 + i];
+    const char *spec = strstr(row + cpp, "c ");
+    if (spec == NULL) {
+      fprintf(stderr, "xpm_bake: %s: unsupported colour \"%s\"\n", argv[1], row);
+      return 1;
+    }
+    spec += 2;
+    while (*spec == ' ' || *spec == '\t')
+      spec++;
+    uint32_t color = TRANSPARENT;
+    if (*spec == '#')
+      color = strtoul(spec + 1, NULL, 16) & 0xFFFFFF;
+    else if (strncmp(spec, "None", 4) != 0) {
+      fprintf(stderr, "xpm_bake: %s: unsupported colour \"%s\"\n", argv[1], row);
+      return 1;
+    }
+    table[pixel_key(row, cpp)] = color;
+  }
+
+  size_t pixels_size = (size_t) width * height * 3;
+  size_t mask_pitch = (width + 7) / 8;
+  size_t blob_size = BAKED_HEADER_SIZE + pixels_size + mask_pitch * height;
+  uint8_t *blob = calloc(blob_size, 1);
+  if (blob == NULL) {
+    fprintf(stderr, "xpm_bake: out of memory\n");
+    return 1;
+  }
+  uint8_t *pixels = blob + BAKED_HEADER_SIZE;
+  uint8_t *mask = pixels + pixels_size;
+  int transparent = 0;
+
+  for (int i = 0; i < height; i++) {
+    const char *row = rows[1 + num_colors + i];
+    if ((int) strlen(row) < width * cpp) {
+      fprintf(stderr, "xpm_bake: %s: row %d is too short\n", argv[1], i);
+      return 1;
+    }
+    for (int j = 0; j < width; j++) {
+      uint32_t color = table[pixel_key(row + j * cpp, cpp)];
+      if (color == UNDEFINED) {
+        // xpm_load() rejects such a pixmap, the baked one must not differ
+        fprintf(stderr, "xpm_bake: %s: row %d uses the undefined pixel \"%.*s\"\n", argv[1], i, cpp, row + j * cpp);
+        return 1;
+      }
+      uint8_t *pixel = pixels + ((size_t) i * width + j) * 3;
+      if (color == TRANSPARENT) {
+        color = CHROMA_KEY_GREEN_888;
+        transparent = 1;
+      }
+      else
+        mask[i * mask_pitch + j / 8] |= 1 << (j % 8);
+      pixel[0] = color & 0xFF;
+      pixel[1] = (color >> 8) & 0xFF;
+      pixel[2] = (color >> 16) & 0xFF;
+    }
+  }
+
+  memcpy(blob, BAKED_MAGIC, 4);
+  put16(blob + 4, BAKED_VERSION);
+  put16(blob + 6, width);
+  put16(blob + 8, height);
+  put16(blob + 10, transparent);
+  put32(blob + 12, CHROMA_KEY_GREEN_888);
+
+  FILE *out = fopen(argv[2], "wb");
+  if (out == NULL || fwrite(blob, 1, blob_size, out) != blob_size) {
+    fprintf(stderr, "xpm_bake: cannot write %s\n", argv[2]);
+    return 1;
+  }
+  fclose(out);
+
+  free(blob);
+  free(table);
+  free(rows);
+  free(text);
+  return 0;
+}